@@ -0,0 +1,62 @@
+#include <stdlib.h>		/* malloc, free */
+#include <assert.h>
+
+#include "allocator.h"
+
+static void *DefaultAlloc(size_t size, void *context)
+{
+	(void)context;
+
+	return (malloc(size));
+}
+
+static void DefaultFree(void *ptr, void *context)
+{
+	(void)context;
+
+	free(ptr);
+}
+
+static const allocator_t g_default_allocator = { DefaultAlloc, DefaultFree, NULL };
+
+/* ************************************************************************************ */
+
+const allocator_t *AllocatorDefault(void)
+{
+	return (&g_default_allocator);
+}
+
+/* ************************************************************************************ */
+
+void *AllocatorAlloc(const allocator_t *allocator, size_t size)
+{
+	assert(allocator != NULL);
+	assert(allocator->alloc != NULL);
+
+	return (allocator->alloc(size, allocator->context));
+}
+
+/* ************************************************************************************ */
+
+void AllocatorFree(const allocator_t *allocator, void *ptr)
+{
+	assert(allocator != NULL);
+	assert(allocator->free != NULL);
+
+	if (ptr != NULL)
+	{
+		allocator->free(ptr, allocator->context);
+	}
+}
+
+/* ************************************************************************************ */
+
+int AllocatorIsSame(const allocator_t *allocator1, const allocator_t *allocator2)
+{
+	assert(allocator1 != NULL);
+	assert(allocator2 != NULL);
+
+	return (allocator1->alloc == allocator2->alloc &&
+			allocator1->free == allocator2->free &&
+			allocator1->context == allocator2->context);
+}
@@ -0,0 +1,39 @@
+#ifndef ALLOCATOR_H_
+#define ALLOCATOR_H_
+
+#include <stddef.h> /* size_t */
+
+/* Memory hooks used by the containers for every internal allocation.
+	A container copies the allocator_t it was created with, so the struct
+	itself may be a temporary; 'context' must outlive the container.
+	Every container takes one through its *CreateWithAllocator function, except:
+	- hazard.c and pslist.c: memory may be released by any thread holding the
+	  last reference or running a scan, and hazard.c grows arrays with realloc.
+	- scheduler.c: task records are allocated and freed on the worker threads.
+	- pool.c and shmqueue.c: they are the memory (a slab, a shared segment).
+	These use malloc/free. */
+
+typedef struct allocator_st allocator_t;
+
+struct allocator_st
+{
+	/* returns NULL on failure */
+	void *(*alloc)(size_t size, void *context);
+	void (*free)(void *ptr, void *context);
+	void *context;
+};
+
+/* Returns the allocator based on malloc/free, used when NULL is passed to a create function */
+const allocator_t *AllocatorDefault(void);
+
+/* Allocate 'size' bytes through allocator, returns NULL on failure */
+void *AllocatorAlloc(const allocator_t *allocator, size_t size);
+
+/* Release ptr (may be NULL) through allocator */
+void AllocatorFree(const allocator_t *allocator, void *ptr);
+
+/* Returns 1 if both allocators have the same functions and context (memory from one
+	may be freed by the other), 0 otherwise */
+int AllocatorIsSame(const allocator_t *allocator1, const allocator_t *allocator2);
+
+#endif   /*   ALLOCATOR_H_    */
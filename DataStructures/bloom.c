@@ -0,0 +1,192 @@
+/* The BLOOM_NUM_HASHES counter indexes come from one call to the user hash by
+	double hashing: index_i = h1 + i * h2 (Kirsch & Mitzenmacher), with h1 and h2
+	two different mixes of the hash value, h2 odd so it steps through a table
+	whose size is a power of 2.
+	COUNTERS_PER_KEY counters per expected key with 7 hashes gives ~1% false positives. */
+
+#include <string.h>		/* memset */
+#include <limits.h>		/* UCHAR_MAX */
+#include <assert.h>
+
+#include "bloom.h"
+
+#define COUNTERS_PER_KEY (10)
+
+struct bloom_st
+{
+	unsigned char *counters;
+	size_t num_counters;	/* power of 2 */
+
+	size_t (*hash)(const void *key, void *param);
+	void *param;
+	allocator_t allocator;
+};
+
+/* ************************************************************************************ */
+
+/* Spread the bits of x, so poor user hashes (e.g. identity on small ints) still work */
+static size_t Mix(size_t x)
+{
+	x ^= x >> 16;
+	x *= 0x45D9F3BUL;
+	x ^= x >> 16;
+	x *= 0x45D9F3BUL;
+	x ^= x >> 16;
+
+	return (x);
+}
+
+/* Fill 'indexes' with the BLOOM_NUM_HASHES counter indexes of key */
+static void CounterIndexes(const bloom_t *bloom, const void *key, size_t *indexes)
+{
+	size_t hash = bloom->hash(key, bloom->param);
+	size_t h1 = Mix(hash);
+	size_t h2 = Mix(hash ^ 0x9E3779B9UL) | 1;
+	size_t i = 0;
+
+	for (i = 0; i < BLOOM_NUM_HASHES; ++i)
+	{
+		indexes[i] = (h1 + i * h2) & (bloom->num_counters - 1);
+	}
+}
+
+/* ************************************************************************************ */
+
+bloom_t *BloomCreate(size_t expected_keys, size_t (*hash)(const void *key, void *param), void *param)
+{
+	return (BloomCreateWithAllocator(expected_keys, hash, param, NULL));
+}
+
+/* ************************************************************************************ */
+
+bloom_t *BloomCreateWithAllocator(size_t expected_keys, size_t (*hash)(const void *key, void *param), void *param,
+								  const allocator_t *allocator)
+{
+	bloom_t *bloom = NULL;
+	size_t num_counters = 64;
+
+	assert(hash != NULL);
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	while (num_counters < expected_keys * COUNTERS_PER_KEY)
+	{
+		num_counters *= 2;
+	}
+
+	bloom = (bloom_t *)AllocatorAlloc(allocator, sizeof(bloom_t));
+	if (NULL == bloom)
+	{
+		return (NULL);
+	}
+
+	bloom->counters = (unsigned char *)AllocatorAlloc(allocator, num_counters);
+	if (NULL == bloom->counters)
+	{
+		AllocatorFree(allocator, bloom);
+		return (NULL);
+	}
+
+	memset(bloom->counters, 0, num_counters);
+	bloom->allocator = *allocator;
+	bloom->num_counters = num_counters;
+	bloom->hash = hash;
+	bloom->param = param;
+
+	return (bloom);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void BloomDestroy(bloom_t *bloom)
+{
+	assert(bloom != NULL);
+
+	AllocatorFree(&bloom->allocator, bloom->counters);
+	AllocatorFree(&bloom->allocator, bloom);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(k) - k hashes ****** */
+void BloomAdd(bloom_t *bloom, const void *key)
+{
+	size_t indexes[BLOOM_NUM_HASHES];
+	size_t i = 0;
+
+	assert(bloom != NULL);
+
+	CounterIndexes(bloom, key, indexes);
+
+	for (i = 0; i < BLOOM_NUM_HASHES; ++i)
+	{
+		if (bloom->counters[indexes[i]] < UCHAR_MAX)
+		{
+			++bloom->counters[indexes[i]];
+		}
+	}
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(k) - k hashes ****** */
+void BloomRemove(bloom_t *bloom, const void *key)
+{
+	size_t indexes[BLOOM_NUM_HASHES];
+	size_t i = 0;
+
+	assert(bloom != NULL);
+
+	CounterIndexes(bloom, key, indexes);
+
+	for (i = 0; i < BLOOM_NUM_HASHES; ++i)
+	{
+		assert(bloom->counters[indexes[i]] > 0);	/* key was never added */
+
+		/* a saturated counter lost track of its count */
+		if (bloom->counters[indexes[i]] < UCHAR_MAX)
+		{
+			--bloom->counters[indexes[i]];
+		}
+	}
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(k) - k hashes ****** */
+int BloomMayContain(const bloom_t *bloom, const void *key)
+{
+	size_t indexes[BLOOM_NUM_HASHES];
+	size_t i = 0;
+
+	assert(bloom != NULL);
+
+	CounterIndexes(bloom, key, indexes);
+
+	for (i = 0; i < BLOOM_NUM_HASHES; ++i)
+	{
+		if (0 == bloom->counters[indexes[i]])
+		{
+			return (0);
+		}
+	}
+
+	return (1);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(m) - m counters ****** */
+void BloomClear(bloom_t *bloom)
+{
+	assert(bloom != NULL);
+
+	memset(bloom->counters, 0, bloom->num_counters);
+
+	return;
+}
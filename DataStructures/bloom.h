@@ -0,0 +1,41 @@
+#ifndef BLOOM_H_
+#define BLOOM_H_
+
+#include <stddef.h> /* size_t */
+
+#include "allocator.h"
+
+/* Counting Bloom filter.
+	Answers "is this key possibly in the set?": a 0 answer is always right, a 1
+	answer may be a false positive (about 1% while no more than 'expected_keys'
+	keys are in the filter). Each key bumps BLOOM_NUM_HASHES one-byte counters, so
+	keys can also be removed. A counter that reaches 255 stays there for good
+	(it can only cause false positives, never false negatives).
+	'hash' must give equal keys equal values - the same equality the lookups use. */
+
+#define BLOOM_NUM_HASHES (7)
+
+typedef struct bloom_st bloom_t;
+
+/* Returns pointer to a new filter sized for 'expected_keys' keys, NULL on failure.
+	Note: must be released by using BloomDestroy. */
+bloom_t *BloomCreate(size_t expected_keys, size_t (*hash)(const void *key, void *param), void *param);
+
+/* Same as BloomCreate, allocating through 'allocator' (NULL for the default malloc/free) */
+bloom_t *BloomCreateWithAllocator(size_t expected_keys, size_t (*hash)(const void *key, void *param), void *param,
+								  const allocator_t *allocator);
+
+void BloomDestroy(bloom_t *bloom);
+
+void BloomAdd(bloom_t *bloom, const void *key);
+
+/* 'key' must have been added (and not yet removed) */
+void BloomRemove(bloom_t *bloom, const void *key);
+
+/* Returns 0 if key is surely not in the filter, 1 if it may be */
+int BloomMayContain(const bloom_t *bloom, const void *key);
+
+/* Remove all keys */
+void BloomClear(bloom_t *bloom);
+
+#endif   /*   BLOOM_H_    */
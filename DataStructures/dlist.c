@@ -1,35 +1,49 @@
-#include <stdlib.h>		/* malloc */
 #include <assert.h>
 
 #include "dlist.h"
+#include "dlist_inline.h"	/* node and dlist layout */
 
-typedef struct dlist_node_st dlist_node_t;
-
-struct dlist_node_st
+/* ************************* */
+/* Move 'data' from the filter of src (if any) to the filter of dest (if any) */
+static void MoveFilterKey(dlist_t *dest, dlist_t *src, const void *data)
 {
-    void *data; /*store node data*/
-    
-    dlist_node_t *next;
-    dlist_node_t *prev;
-};
+	if (src->filter != NULL)
+	{
+		BloomRemove(src->filter, data);
+	}
+	
+	if (dest->filter != NULL)
+	{
+		BloomAdd(dest->filter, data);
+	}
+}
 
-struct dlist_st
+/* ************************* */
+dlist_t *DlistCreate(void)
 {
-    dlist_node_t head;
-    dlist_node_t tail;
-};
+	return (DlistCreateWithAllocator(NULL));
+}
 
 /* ************************* */
-dlist_t *DlistCreate(void)
+dlist_t *DlistCreateWithAllocator(const allocator_t *allocator)
 {
 	dlist_t *dlist;
 	
-	dlist = (dlist_t *)malloc(sizeof(dlist_t));
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+	
+	dlist = (dlist_t *)AllocatorAlloc(allocator, sizeof(dlist_t));
 	if (NULL == dlist)
 	{
 		return (NULL);
 	}
 	
+	dlist->allocator = *allocator;
+	dlist->size = 0;
+	dlist->filter = NULL;
+	
 	(dlist->head).data = NULL;
 	(dlist->head).next = &(dlist->tail);
 	(dlist->head).prev = NULL;
@@ -49,34 +63,24 @@ void DlistDestroy(dlist_t *dlist)
 {
 	assert (dlist != NULL);
 	
+	DlistDetachFilter(dlist);
+	
 	while (!DlistIsEmpty(dlist))
 	{
 		DlistPopFront(dlist);
 	}
 	
-	free(dlist);
+	AllocatorFree(&dlist->allocator, dlist);
 	
 	return;
 }
 /* ************************* */	
-/*  **** Complexity: O(n) ****** */
+/*  **** Complexity: O(1) ****** */
 size_t DlistSize(const dlist_t *dlist)
 {
-	size_t count = 0;
-	dlist_iter_t curr = NULL;
-	dlist_iter_t end = NULL;
-		
 	assert (dlist != NULL);  
 	
-	curr = DlistBegin(dlist);
-	end = DlistEnd(dlist);
-		
-	for (; !DlistIsSameIter(curr, end) ; curr = DlistNext(curr))
-	{
-		++count;
-	}
-	
-	return (count);
+	return (dlist->size);
 }
 /* ************************* */	
 /*  **** Complexity: O(1) ****** */
@@ -91,7 +95,6 @@ int DlistIsEmpty(const dlist_t *dlist)
 /*  **** Complexity: O(1) ****** */
 dlist_iter_t DlistBegin(const dlist_t *dlist)
 {
-
 	assert (dlist != NULL);
 
 	return ((dlist->head).next);
@@ -157,7 +160,7 @@ dlist_iter_t DlistInsertAfter(dlist_t *dlist, dlist_iter_t where, void *data)
 	assert (where != NULL);
 	assert (where->next != NULL);
 	
-	new_node = (dlist_node_t *)malloc(sizeof(dlist_node_t));
+	new_node = (dlist_node_t *)AllocatorAlloc(&dlist->allocator, sizeof(dlist_node_t));
 	if (NULL == new_node)
 	{
 		return (DlistEnd(dlist));
@@ -170,6 +173,13 @@ dlist_iter_t DlistInsertAfter(dlist_t *dlist, dlist_iter_t where, void *data)
 	(DlistNext(where))->prev = new_node;	
 	where->next = new_node;
 	
+	++dlist->size;
+	
+	if (dlist->filter != NULL)
+	{
+		BloomAdd(dlist->filter, data);
+	}
+	
 	return (new_node);
 }
 
@@ -204,18 +214,26 @@ void *DlistGetData(dlist_iter_t where)
 /* ************************** */
 /* **** Complexity: O(1) **** */
 /* returns iter to the next node */
-dlist_iter_t DlistErase(dlist_iter_t iter)
+dlist_iter_t DlistEraseFrom(dlist_t *dlist, dlist_iter_t iter)
 {
 	dlist_iter_t ret_iter = NULL;
 	
+	assert(dlist != NULL);
 	assert(iter != NULL);
 	assert(iter->next != NULL);
 	
 	ret_iter = DlistNext(iter);
 
+	if (dlist->filter != NULL)
+	{
+		BloomRemove(dlist->filter, iter->data);
+	}
+
 	DlistPrev(iter)->next = DlistNext(iter);
 	DlistNext(iter)->prev = DlistPrev(iter);
-	free(iter);
+	AllocatorFree(&dlist->allocator, iter);
+	
+	--dlist->size;
 	
 	return (ret_iter);
 }
@@ -247,6 +265,71 @@ dlist_iter_t DlistFind(dlist_iter_t from,
 }
 
 
+/* ************************** */
+/* **** Complexity: O(n) **** */	
+int DlistAttachFilter(dlist_t *dlist, size_t expected_size,
+                      size_t (*hash)(const void *data, void *param), void *param)
+{
+	bloom_t *filter = NULL;
+	dlist_iter_t curr = NULL;
+	
+	assert(dlist != NULL);
+	assert(hash != NULL);
+	
+	filter = BloomCreateWithAllocator(expected_size, hash, param, &dlist->allocator);
+	if (NULL == filter)
+	{
+		return (1);
+	}
+	
+	for (curr = DlistBegin(dlist); !DlistIsSameIter(curr, DlistEnd(dlist)); curr = DlistNext(curr))
+	{
+		BloomAdd(filter, DlistGetData(curr));
+	}
+	
+	DlistDetachFilter(dlist);
+	dlist->filter = filter;
+	
+	return (0);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */	
+void DlistDetachFilter(dlist_t *dlist)
+{
+	assert(dlist != NULL);
+	
+	if (dlist->filter != NULL)
+	{
+		BloomDestroy(dlist->filter);
+		dlist->filter = NULL;
+	}
+	
+	return;
+}
+
+/* ************************** */
+/* **** Complexity: O(1) on a filtered miss, O(n) otherwise **** */	
+dlist_iter_t DlistFindFiltered(const dlist_t *dlist,
+                 int (*is_match)
+                     (const void *node_data,
+                     const void *data,
+                     void *param),
+                 const void *data,
+                  void *param)
+{
+	assert(dlist != NULL);
+	assert(is_match != NULL);
+	
+	if (dlist->filter != NULL && !BloomMayContain(dlist->filter, data))
+	{
+		return (DlistEnd(dlist));
+	}
+	
+	return (DlistFind(DlistBegin(dlist), DlistEnd(dlist), is_match, data, param));
+}
+
+
 /* ************************** */
 /* **** Complexity: O(1) **** */			
 void *DlistPopFront(dlist_t *dlist)
@@ -260,7 +343,7 @@ void *DlistPopFront(dlist_t *dlist)
 	iter_to_pop = DlistBegin(dlist);
 	ret_data = DlistGetData(iter_to_pop);
 	
-	DlistErase(iter_to_pop);
+	DlistEraseFrom(dlist, iter_to_pop);
 	
 	return (ret_data);
 }
@@ -279,7 +362,7 @@ void *DlistPopBack(dlist_t *dlist)
 	iter_to_pop = DlistPrev(DlistEnd(dlist));
 	ret_data = DlistGetData(iter_to_pop);
 	
-	DlistErase(iter_to_pop);
+	DlistEraseFrom(dlist, iter_to_pop);
 	
 	return (ret_data);
 }
@@ -336,6 +419,38 @@ dlist_iter_t DlistSplice(dlist_iter_t where, dlist_iter_t from, dlist_iter_t to)
 	
 	return (ret_iter);
 }
-	
 
-	
+/* ************************** */
+/* **** Complexity: O(1) within a list or for a whole list, O(to - from) otherwise **** */			
+dlist_iter_t DlistSpliceFrom(dlist_t *dest, dlist_iter_t where,
+                             dlist_t *src, dlist_iter_t from, dlist_iter_t to)
+{
+	dlist_iter_t curr = NULL;
+	size_t count = 0;
+
+	assert(dest != NULL);
+	assert(src != NULL);
+	assert(AllocatorIsSame(&dest->allocator, &src->allocator));
+
+	if (dest != src)
+	{
+		if (DlistIsSameIter(from, DlistBegin(src)) && DlistIsSameIter(to, DlistEnd(src)) &&
+			NULL == src->filter && NULL == dest->filter)
+		{
+			count = src->size;
+		}
+		else
+		{
+			for (curr = from; !DlistIsSameIter(curr, to); curr = DlistNext(curr))
+			{
+				MoveFilterKey(dest, src, curr->data);
+				++count;
+			}
+		}
+
+		src->size -= count;
+		dest->size += count;
+	}
+
+	return (DlistSplice(where, from, to));
+}
@@ -3,12 +3,18 @@
 
 #include <stddef.h>
 
+#include "allocator.h"
+
 typedef struct dlist_st dlist_t;
 
 typedef struct dlist_node_st *dlist_iter_t;
 
 dlist_t *DlistCreate(void);
 
+/* Same as DlistCreate, the dlist and its nodes are allocated through 'allocator'
+	(NULL for the default malloc/free) */
+dlist_t *DlistCreateWithAllocator(const allocator_t *allocator);
+
 void DlistDestroy(dlist_t* dlist);
 
 /* returns the number of elements in the dlist*/
@@ -41,8 +47,10 @@ dlist_iter_t DlistPushFront(dlist_t *dlist ,void *data);
 /* returns node data or Null if the dlist is empty*/
 void *DlistGetData(dlist_iter_t where);
 
-/* returns iter to the next node */
-dlist_iter_t DlistErase(dlist_iter_t iter);
+/* returns iter to the next node. 'dlist' is the list iter belongs to. O(1)
+	Note: replaces DlistErase(iter), which can't reach the list's allocator,
+	size and filter from a node in O(1) */
+dlist_iter_t DlistEraseFrom(dlist_t *dlist, dlist_iter_t iter);
 
 /* returns iter_t to upon failure*/
 dlist_iter_t DlistFind(dlist_iter_t from,
@@ -54,6 +62,25 @@ dlist_iter_t DlistFind(dlist_iter_t from,
                  const void *data,
                   void *param);
                  
+/* Attach a counting Bloom filter sized for 'expected_size' elements and add the current
+	elements to it. 'hash' hashes element data, and must agree with the is_match passed
+	to DlistFindFiltered (matching data, equal hash). The filter is kept up to date on
+	insert, erase and DlistSpliceFrom. Returns 0 on success, 1 on failure */
+int DlistAttachFilter(dlist_t *dlist, size_t expected_size,
+                      size_t (*hash)(const void *data, void *param), void *param);
+
+void DlistDetachFilter(dlist_t *dlist);
+
+/* Same as DlistFind over the whole dlist, but returns END without walking the list
+	when the filter shows 'data' is missing (a full search if no filter is attached) */
+dlist_iter_t DlistFindFiltered(const dlist_t *dlist,
+                 int (*is_match)
+                     (const void *node_data,
+                     const void *data,
+                     void *param),
+                 const void *data,
+                  void *param);
+
 /* returns the popped data */
 void *DlistPopFront(dlist_t *dlist);
 
@@ -67,8 +94,16 @@ int DlistForEach(dlist_iter_t from, dlist_iter_t to,
                 void *param),
                 void *param);
 
-/* returns iter to the last spliced element*/
+/* returns iter to the last spliced element. 'where' must be in the same list as from..to,
+	use DlistSpliceFrom to move elements between lists (keeps both sizes right) */
 dlist_iter_t DlistSplice(dlist_iter_t where, dlist_iter_t from, dlist_iter_t to);
+
+/* moves from..to (not including 'to') of 'src' before 'where' of 'dest', returns iter to the
+	last spliced element. Both lists must use the same allocator.
+	O(1) when dest == src or when the whole of 'src' is moved (and neither list has a filter),
+	otherwise walks the range */
+dlist_iter_t DlistSpliceFrom(dlist_t *dest, dlist_iter_t where,
+                             dlist_t *src, dlist_iter_t from, dlist_iter_t to);
     
 #endif /*DLIST*/
 
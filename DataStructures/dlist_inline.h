@@ -0,0 +1,106 @@
+#ifndef DLIST_INLINE_H_
+#define DLIST_INLINE_H_
+
+#include <assert.h>
+
+#include "dlist.h"
+#include "bloom.h"
+
+/* Opt-in inline versions of the dlist accessors, for hot traversal loops.
+	Including this header exposes the dlist layout: code that uses it must be
+	rebuilt whenever this header changes. The rest of the API stays in dlist.h.
+	Before C99 there is no 'inline': the XxxInline names then call the
+	out-of-line functions of dlist.c. */
+
+typedef struct dlist_node_st dlist_node_t;
+
+struct dlist_node_st
+{
+    void *data; /*store node data*/
+    
+    dlist_node_t *next;
+    dlist_node_t *prev;
+};
+
+struct dlist_st
+{
+    dlist_node_t head;
+    dlist_node_t tail;
+    size_t size; /*number of elements*/
+    bloom_t *filter; /*NULL unless DlistAttachFilter was called*/
+    
+    allocator_t allocator; /*used for the dlist and its nodes*/
+};
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline dlist_iter_t DlistBeginInline(const dlist_t *dlist)
+{
+	assert (dlist != NULL);
+
+	return ((dlist->head).next);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline dlist_iter_t DlistEndInline(const dlist_t *dlist)
+{
+	assert (dlist != NULL);
+	
+	return ((dlist_iter_t)&(dlist->tail));
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline int DlistIsSameIterInline(dlist_iter_t iter_1, dlist_iter_t iter_2)
+{
+	assert (iter_1 != NULL);
+	assert (iter_2 != NULL);
+
+	return (iter_1 == iter_2);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline dlist_iter_t DlistNextInline(dlist_iter_t iter)
+{
+	assert (iter != NULL);
+	assert (iter->next != NULL);
+
+	return (iter->next);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline dlist_iter_t DlistPrevInline(dlist_iter_t iter)
+{
+	assert (iter != NULL);
+	assert (iter->prev != NULL);
+
+	return (iter->prev);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+static inline void *DlistGetDataInline(dlist_iter_t where)
+{
+	assert (where != NULL);
+	assert (where->next != NULL);
+	
+	return (where->data);
+}
+
+#else /* C89 */
+
+#define DlistBeginInline DlistBegin
+#define DlistEndInline DlistEnd
+#define DlistIsSameIterInline DlistIsSameIter
+#define DlistNextInline DlistNext
+#define DlistPrevInline DlistPrev
+#define DlistGetDataInline DlistGetData
+
+#endif /* C99 */
+
+#endif /*DLIST_INLINE_H_*/
@@ -0,0 +1,180 @@
+/* Invariant, kept under the lock: the eventfd counter is non-zero iff the queue
+	is not empty. Enqueue writes 1 on the empty to non-empty transition, and the
+	consumer reads the counter back to 0 when it empties the queue. */
+
+#include <assert.h>
+#include <stdint.h>			/* uint64_t */
+#include <pthread.h>
+#include <unistd.h>			/* read, write, close */
+#include <sys/eventfd.h>
+
+#include "evqueue.h"
+
+struct ev_queue_st
+{
+	pthread_mutex_t lock;
+	queue_t *queue;
+	int fd;
+	allocator_t allocator;
+};
+
+/* ************************************************************************************ */
+
+static void Signal(const ev_queue_t *evqueue)
+{
+	uint64_t one = 1;
+	ssize_t status = write(evqueue->fd, &one, sizeof(one));
+
+	/* the counter is 0 here, so the write can't fail with EAGAIN */
+	assert(sizeof(one) == status);
+	(void)status;
+}
+
+static void ClearSignal(const ev_queue_t *evqueue)
+{
+	uint64_t count = 0;
+	ssize_t status = read(evqueue->fd, &count, sizeof(count));
+
+	assert(sizeof(count) == status);
+	(void)status;
+}
+
+/* ************************************************************************************ */
+
+ev_queue_t *EvQueueCreate(void)
+{
+	return (EvQueueCreateWithAllocator(NULL));
+}
+
+/* ************************************************************************************ */
+
+ev_queue_t *EvQueueCreateWithAllocator(const allocator_t *allocator)
+{
+	ev_queue_t *evqueue = NULL;
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	evqueue = (ev_queue_t *)AllocatorAlloc(allocator, sizeof(ev_queue_t));
+	if (NULL == evqueue)
+	{
+		return (NULL);
+	}
+
+	evqueue->queue = QueueCreateWithAllocator(allocator);
+	if (NULL == evqueue->queue)
+	{
+		AllocatorFree(allocator, evqueue);
+		return (NULL);
+	}
+
+	evqueue->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (evqueue->fd < 0)
+	{
+		QueueDestroy(evqueue->queue);
+		AllocatorFree(allocator, evqueue);
+		return (NULL);
+	}
+
+	evqueue->allocator = *allocator;
+	pthread_mutex_init(&evqueue->lock, NULL);
+
+	return (evqueue);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(n) ****** */
+void EvQueueDestroy(ev_queue_t *evqueue)
+{
+	assert(evqueue != NULL);
+
+	close(evqueue->fd);
+	pthread_mutex_destroy(&evqueue->lock);
+	QueueDestroy(evqueue->queue);
+	AllocatorFree(&evqueue->allocator, evqueue);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+int EvQueueFd(const ev_queue_t *evqueue)
+{
+	assert(evqueue != NULL);
+
+	return (evqueue->fd);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+int EvQueueEnqueue(ev_queue_t *evqueue, void *data)
+{
+	int was_empty = 0;
+	int status = 0;
+
+	assert(evqueue != NULL);
+
+	pthread_mutex_lock(&evqueue->lock);
+
+	was_empty = QueueIsEmpty(evqueue->queue);
+	status = QueueEnqueue(evqueue->queue, data);
+	if (0 == status && was_empty)
+	{
+		Signal(evqueue);
+	}
+
+	pthread_mutex_unlock(&evqueue->lock);
+
+	return (status);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(QUEUE_INLINE_CAPACITY) ****** */
+int EvQueueTakeAll(ev_queue_t *evqueue, queue_t *out)
+{
+	int status = 0;
+
+	assert(evqueue != NULL);
+	assert(out != NULL);
+
+	pthread_mutex_lock(&evqueue->lock);
+
+	if (!QueueIsEmpty(evqueue->queue))
+	{
+		status = QueueAppend(out, evqueue->queue);
+		if (0 == status)
+		{
+			ClearSignal(evqueue);
+		}
+	}
+
+	pthread_mutex_unlock(&evqueue->lock);
+
+	return (status);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void *EvQueueDequeue(ev_queue_t *evqueue)
+{
+	void *ret_data = NULL;
+
+	assert(evqueue != NULL);
+
+	pthread_mutex_lock(&evqueue->lock);
+
+	if (!QueueIsEmpty(evqueue->queue))
+	{
+		ret_data = QueueDequeue(evqueue->queue);
+		if (QueueIsEmpty(evqueue->queue))
+		{
+			ClearSignal(evqueue);
+		}
+	}
+
+	pthread_mutex_unlock(&evqueue->lock);
+
+	return (ret_data);
+}
@@ -0,0 +1,43 @@
+#ifndef EVQUEUE_H_
+#define EVQUEUE_H_
+
+#include "allocator.h"
+#include "queue.h"
+
+/* Thread safe queue for event loops: a locked queue_t paired with a Linux eventfd.
+	The fd is readable exactly while the queue is not empty; producers write to it
+	only when the queue goes from empty to non-empty, so a burst of enqueues costs
+	one wakeup. A consumer registers EvQueueFd in epoll/poll (EPOLLIN) and, when it
+	fires, drains everything at once with EvQueueTakeAll (or one by one with
+	EvQueueDequeue) without ever blocking. */
+
+typedef struct ev_queue_st ev_queue_t;
+
+/* Returns pointer to a new queue, NULL on failure.
+	Note: must be released by using EvQueueDestroy. */
+ev_queue_t *EvQueueCreate(void);
+
+/* Same as EvQueueCreate, allocating through 'allocator' (NULL for the default malloc/free).
+	'allocator' must be thread safe. */
+ev_queue_t *EvQueueCreateWithAllocator(const allocator_t *allocator);
+
+/* Destroy the queue and close its fd, remove the fd from any epoll set first */
+void EvQueueDestroy(ev_queue_t *evqueue);
+
+/* Returns the eventfd to wait on for reading. Owned by the queue, don't read or close it */
+int EvQueueFd(const ev_queue_t *evqueue);
+
+/* Push data to the end of the queue, waking the consumer if the queue was empty.
+	Returns 0 for success and 1 for failure */
+int EvQueueEnqueue(ev_queue_t *evqueue, void *data);
+
+/* Move every element to the end of 'out', 'out' must use the same allocator.
+	O(QUEUE_INLINE_CAPACITY) (see QueueAppend): the inline elements are copied and
+	may need new nodes, allocated while the queue's lock is held.
+	Returns 0 for success and 1 for failure (nothing is moved) */
+int EvQueueTakeAll(ev_queue_t *evqueue, queue_t *out);
+
+/* Remove data from the head of the queue, returns NULL if the queue is empty */
+void *EvQueueDequeue(ev_queue_t *evqueue);
+
+#endif   /*   EVQUEUE_H_    */
@@ -0,0 +1,377 @@
+/* Hazard pointers (Michael, 2004).
+	Records are kept in a lock-free list that only grows; a released record is
+	marked inactive and reused by the next HazardAcquire.
+	Each record has a private array of retired pointers. When it holds
+	RETIRE_FACTOR times the total number of slots, HazardScan collects all
+	published hazards into a sorted array and reclaims every retired pointer
+	not found in it - so a scan frees at least half of the retired pointers
+	and the amortized cost per retire is O(log(slots)). */
+
+#include <stdlib.h>		/* malloc, realloc, free, qsort, bsearch */
+#include <assert.h>
+
+#include "hazard.h"
+
+#define RETIRE_FACTOR (2)
+#define MIN_RETIRE_THRESHOLD (64)
+
+struct hazard_record_st
+{
+	hazard_record_t *next;		/* next record in the domain */
+	hazard_domain_t *domain;
+	int active;
+
+	void **retired;
+	size_t num_retired;
+	size_t retired_capacity;
+
+	void *slots[1];				/* 'slots_per_record' hazard pointers */
+};
+
+struct hazard_domain_st
+{
+	hazard_record_t *records;
+	size_t num_records;
+	size_t slots_per_record;
+
+	void (*reclaim)(void *ptr, void *param);
+	void *param;
+};
+
+/* ************************************************************************************ */
+
+static int ComparePointers(const void *ptr1, const void *ptr2)
+{
+	const char *p1 = *(char *const *)ptr1;
+	const char *p2 = *(char *const *)ptr2;
+
+	return ((p1 > p2) - (p1 < p2));
+}
+
+/* Number of retired pointers that triggers a scan */
+static size_t RetireThreshold(const hazard_domain_t *domain)
+{
+	size_t threshold = RETIRE_FACTOR * domain->slots_per_record *
+					   __atomic_load_n(&domain->num_records, __ATOMIC_RELAXED);
+
+	return ((threshold < MIN_RETIRE_THRESHOLD) ? MIN_RETIRE_THRESHOLD : threshold);
+}
+
+/* Copy all published hazards to 'hazards', returns the count.
+	Returns more than max_hazards if records were added meanwhile and didn't fit */
+static size_t CollectHazards(const hazard_domain_t *domain, void **hazards, size_t max_hazards)
+{
+	const hazard_record_t *record = NULL;
+	void *ptr = NULL;
+	size_t num_hazards = 0;
+	size_t i = 0;
+
+	for (record = __atomic_load_n(&domain->records, __ATOMIC_ACQUIRE);
+		 record != NULL && num_hazards <= max_hazards;
+		 record = record->next)
+	{
+		for (i = 0; i < domain->slots_per_record; ++i)
+		{
+			ptr = __atomic_load_n(&record->slots[i], __ATOMIC_SEQ_CST);
+			if (ptr != NULL)
+			{
+				if (num_hazards == max_hazards)
+				{
+					return (max_hazards + 1);
+				}
+				hazards[num_hazards++] = ptr;
+			}
+		}
+	}
+
+	return (num_hazards);
+}
+
+/* Returns 1 if ptr is published in any slot, used when there is no memory to sort the hazards */
+static int IsHazard(const hazard_domain_t *domain, const void *ptr)
+{
+	const hazard_record_t *record = NULL;
+	size_t i = 0;
+
+	for (record = __atomic_load_n(&domain->records, __ATOMIC_ACQUIRE); record != NULL; record = record->next)
+	{
+		for (i = 0; i < domain->slots_per_record; ++i)
+		{
+			if (__atomic_load_n(&record->slots[i], __ATOMIC_SEQ_CST) == ptr)
+			{
+				return (1);
+			}
+		}
+	}
+
+	return (0);
+}
+
+/* ************************************************************************************ */
+
+hazard_domain_t *HazardDomainCreate(size_t slots_per_record,
+									void (*reclaim)(void *ptr, void *param), void *param)
+{
+	hazard_domain_t *domain = NULL;
+
+	assert(slots_per_record > 0);
+	assert(reclaim != NULL);
+
+	domain = (hazard_domain_t *)malloc(sizeof(hazard_domain_t));
+	if (NULL == domain)
+	{
+		return (NULL);
+	}
+
+	domain->records = NULL;
+	domain->num_records = 0;
+	domain->slots_per_record = slots_per_record;
+	domain->reclaim = reclaim;
+	domain->param = param;
+
+	return (domain);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(records + retired) ****** */
+void HazardDomainDestroy(hazard_domain_t *domain)
+{
+	hazard_record_t *record = NULL;
+	hazard_record_t *next = NULL;
+	size_t i = 0;
+
+	assert(domain != NULL);
+
+	for (record = domain->records; record != NULL; record = next)
+	{
+		next = record->next;
+
+		for (i = 0; i < record->num_retired; ++i)
+		{
+			domain->reclaim(record->retired[i], domain->param);
+		}
+
+		free(record->retired);
+		free(record);
+	}
+
+	free(domain);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(records) ****** */
+hazard_record_t *HazardAcquire(hazard_domain_t *domain)
+{
+	hazard_record_t *record = NULL;
+	int expected = 0;
+	size_t i = 0;
+
+	assert(domain != NULL);
+
+	/* reuse a released record */
+	for (record = __atomic_load_n(&domain->records, __ATOMIC_ACQUIRE); record != NULL; record = record->next)
+	{
+		expected = 0;
+		if (__atomic_compare_exchange_n(&record->active, &expected, 1, 0,
+										__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			return (record);
+		}
+	}
+
+	record = (hazard_record_t *)malloc(sizeof(hazard_record_t) +
+									   (domain->slots_per_record - 1) * sizeof(void *));
+	if (NULL == record)
+	{
+		return (NULL);
+	}
+
+	record->domain = domain;
+	record->active = 1;
+	record->retired = NULL;
+	record->num_retired = 0;
+	record->retired_capacity = 0;
+	for (i = 0; i < domain->slots_per_record; ++i)
+	{
+		record->slots[i] = NULL;
+	}
+
+	/* push to the head of the records list */
+	record->next = __atomic_load_n(&domain->records, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&domain->records, &record->next, record, 1,
+										__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	{
+	}
+	__atomic_add_fetch(&domain->num_records, 1, __ATOMIC_RELAXED);
+
+	return (record);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(slots) ****** */
+void HazardRelease(hazard_record_t *record)
+{
+	size_t i = 0;
+
+	assert(record != NULL);
+
+	for (i = 0; i < record->domain->slots_per_record; ++i)
+	{
+		HazardClear(record, i);
+	}
+
+	__atomic_store_n(&record->active, 0, __ATOMIC_RELEASE);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) (retries while *src keeps changing) ****** */
+void *HazardProtect(hazard_record_t *record, size_t slot, void *const *src)
+{
+	void *ptr = NULL;
+	void *check = NULL;
+
+	assert(record != NULL);
+	assert(slot < record->domain->slots_per_record);
+	assert(src != NULL);
+
+	ptr = __atomic_load_n(src, __ATOMIC_ACQUIRE);
+
+	for (;;)
+	{
+		/* seq_cst so a scanner that doesn't see the hazard sees the node already unlinked */
+		__atomic_store_n(&record->slots[slot], ptr, __ATOMIC_SEQ_CST);
+
+		check = __atomic_load_n(src, __ATOMIC_SEQ_CST);
+		if (check == ptr)
+		{
+			return (ptr);
+		}
+
+		ptr = check;
+	}
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void HazardSet(hazard_record_t *record, size_t slot, void *ptr)
+{
+	assert(record != NULL);
+	assert(slot < record->domain->slots_per_record);
+
+	__atomic_store_n(&record->slots[slot], ptr, __ATOMIC_SEQ_CST);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void HazardClear(hazard_record_t *record, size_t slot)
+{
+	assert(record != NULL);
+	assert(slot < record->domain->slots_per_record);
+
+	__atomic_store_n(&record->slots[slot], NULL, __ATOMIC_RELEASE);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) amortized ****** */
+int HazardRetire(hazard_record_t *record, void *ptr)
+{
+	void **new_retired = NULL;
+	size_t new_capacity = 0;
+
+	assert(record != NULL);
+	assert(ptr != NULL);
+
+	if (record->num_retired == record->retired_capacity)
+	{
+		new_capacity = (0 == record->retired_capacity) ? MIN_RETIRE_THRESHOLD : record->retired_capacity * 2;
+
+		new_retired = (void **)realloc(record->retired, new_capacity * sizeof(void *));
+		if (new_retired != NULL)
+		{
+			record->retired = new_retired;
+			record->retired_capacity = new_capacity;
+		}
+		else if (HazardScan(record) == record->retired_capacity)
+		{
+			/* nothing could be reclaimed and there is no room */
+			return (1);
+		}
+	}
+
+	record->retired[record->num_retired++] = ptr;
+
+	if (record->num_retired >= RetireThreshold(record->domain))
+	{
+		HazardScan(record);
+	}
+
+	return (0);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(R log H) - R retired, H hazards ****** */
+size_t HazardScan(hazard_record_t *record)
+{
+	hazard_domain_t *domain = NULL;
+	void **hazards = NULL;
+	size_t max_hazards = 0;
+	size_t num_hazards = 0;
+	size_t num_kept = 0;
+	size_t i = 0;
+	int is_hazard = 0;
+
+	assert(record != NULL);
+
+	domain = record->domain;
+
+	/* pairs with the seq_cst publication in HazardProtect */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	max_hazards = domain->slots_per_record * __atomic_load_n(&domain->num_records, __ATOMIC_ACQUIRE);
+	hazards = (void **)malloc(max_hazards * sizeof(void *));
+	if (hazards != NULL)
+	{
+		num_hazards = CollectHazards(domain, hazards, max_hazards);
+		if (num_hazards > max_hazards)
+		{
+			/* fall back to checking every slot per retired pointer */
+			free(hazards);
+			hazards = NULL;
+		}
+		else
+		{
+			qsort(hazards, num_hazards, sizeof(void *), ComparePointers);
+		}
+	}
+
+	for (i = 0; i < record->num_retired; ++i)
+	{
+		if (hazards != NULL)
+		{
+			is_hazard = (NULL != bsearch(&record->retired[i], hazards, num_hazards,
+										 sizeof(void *), ComparePointers));
+		}
+		else
+		{
+			is_hazard = IsHazard(domain, record->retired[i]);
+		}
+
+		if (is_hazard)
+		{
+			record->retired[num_kept++] = record->retired[i];
+		}
+		else
+		{
+			domain->reclaim(record->retired[i], domain->param);
+		}
+	}
+
+	record->num_retired = num_kept;
+	free(hazards);
+
+	return (num_kept);
+}
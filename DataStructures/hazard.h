@@ -0,0 +1,53 @@
+#ifndef HAZARD_H_
+#define HAZARD_H_
+
+#include <stddef.h> /* size_t */
+
+/* Hazard pointer memory reclamation for lock-free containers.
+	A thread publishes the nodes it is about to read in the hazard slots of its
+	record. A node removed from a container is retired instead of freed, and is
+	handed to the reclaim function only when no hazard slot points to it.
+	The domain's own memory comes from malloc/realloc/free, not an allocator_t:
+	the retired arrays grow with realloc. */
+
+typedef struct hazard_domain_st hazard_domain_t;
+
+typedef struct hazard_record_st hazard_record_t;
+
+/* Returns pointer to a new domain, NULL on failure.
+	slots_per_record: number of pointers one thread may protect at a time.
+	reclaim: called with each retired pointer once it is safe to free (e.g. a wrapper of free).
+	Note: must be released by using HazardDomainDestroy. */
+hazard_domain_t *HazardDomainCreate(size_t slots_per_record,
+									void (*reclaim)(void *ptr, void *param), void *param);
+
+/* Reclaim every retired pointer and free the domain. No thread may use it anymore */
+void HazardDomainDestroy(hazard_domain_t *domain);
+
+/* Returns a record for the calling thread (reusing a released one when possible), NULL on failure.
+	A record must be used by one thread at a time. */
+hazard_record_t *HazardAcquire(hazard_domain_t *domain);
+
+/* Clear the record's slots and give it back. Its retired pointers are kept
+	for the next thread that acquires it. */
+void HazardRelease(hazard_record_t *record);
+
+/* Load the pointer stored in *src and protect it in 'slot', retrying until
+	the published value is still the one in *src. Returns the protected pointer. */
+void *HazardProtect(hazard_record_t *record, size_t slot, void *const *src);
+
+/* Publish ptr in 'slot'. The caller must check ptr is still reachable afterwards */
+void HazardSet(hazard_record_t *record, size_t slot, void *ptr);
+
+void HazardClear(hazard_record_t *record, size_t slot);
+
+/* Retire ptr, which is no longer reachable from the container.
+	Triggers a scan when enough pointers are retired.
+	Returns 0 for success and 1 for failure (no memory to hold it, ptr was not retired) */
+int HazardRetire(hazard_record_t *record, void *ptr);
+
+/* Reclaim every pointer retired through record that no slot protects.
+	Returns the number of pointers still retired. */
+size_t HazardScan(hazard_record_t *record);
+
+#endif   /*   HAZARD_H_    */
@@ -0,0 +1,393 @@
+/* The hash map uses separate chaining: each bucket is a singly linked chain of
+	entries, the table doubles when there are more entries than buckets.
+	Each entry remembers its dlist iterator, and the dlist node holds the entry,
+	so both structures reach each other in O(1). */
+
+#include <string.h>		/* memset */
+#include <assert.h>
+
+#include "dlist.h"
+#include "lrucache.h"
+
+#define INIT_NUM_BUCKETS (16)
+
+typedef struct lru_entry_st lru_entry_t;
+
+struct lru_entry_st
+{
+	void *key;
+	void *value;
+	size_t bytes;
+	size_t hash;
+	lru_entry_t *next;		/* next entry in the same bucket */
+	dlist_iter_t iter;		/* position in the recency list */
+};
+
+struct lru_cache_st
+{
+	dlist_t *recency;		/* most recently used first */
+	lru_entry_t **buckets;
+	size_t num_buckets;		/* power of 2 */
+	size_t num_entries;
+	size_t bytes;
+
+	size_t max_entries;
+	size_t max_bytes;
+
+	size_t (*hash)(const void *key, void *param);
+	int (*is_match)(const void *key1, const void *key2, void *param);
+	void (*release)(void *key, void *value, void *param);
+	void *param;
+
+	lru_stats_t stats;
+	allocator_t allocator;	/* used for the cache, its entries and buckets */
+};
+
+/* ************************************************************************************ */
+
+/* Returns the link pointing to the entry of key (a link holding NULL if there is none) */
+static lru_entry_t **FindLink(const lru_cache_t *cache, const void *key, size_t hash)
+{
+	lru_entry_t **link = &cache->buckets[hash & (cache->num_buckets - 1)];
+
+	while (*link != NULL &&
+		   !((*link)->hash == hash && cache->is_match((*link)->key, key, cache->param)))
+	{
+		link = &(*link)->next;
+	}
+
+	return (link);
+}
+
+/* Returns the link pointing to entry */
+static lru_entry_t **EntryLink(const lru_cache_t *cache, const lru_entry_t *entry)
+{
+	lru_entry_t **link = &cache->buckets[entry->hash & (cache->num_buckets - 1)];
+
+	while (*link != entry)
+	{
+		link = &(*link)->next;
+	}
+
+	return (link);
+}
+
+/* Returns a zeroed array of num_buckets buckets, NULL on failure */
+static lru_entry_t **AllocBuckets(const lru_cache_t *cache, size_t num_buckets)
+{
+	lru_entry_t **buckets = (lru_entry_t **)AllocatorAlloc(&cache->allocator,
+														   num_buckets * sizeof(lru_entry_t *));
+
+	if (buckets != NULL)
+	{
+		memset(buckets, 0, num_buckets * sizeof(lru_entry_t *));
+	}
+
+	return (buckets);
+}
+
+/* Double the number of buckets. On failure the cache keeps working with the old table */
+static void GrowBuckets(lru_cache_t *cache)
+{
+	lru_entry_t **new_buckets = NULL;
+	lru_entry_t *entry = NULL;
+	lru_entry_t *next = NULL;
+	size_t new_num_buckets = cache->num_buckets * 2;
+	size_t i = 0;
+
+	new_buckets = AllocBuckets(cache, new_num_buckets);
+	if (NULL == new_buckets)
+	{
+		return;
+	}
+
+	for (i = 0; i < cache->num_buckets; ++i)
+	{
+		for (entry = cache->buckets[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			entry->next = new_buckets[entry->hash & (new_num_buckets - 1)];
+			new_buckets[entry->hash & (new_num_buckets - 1)] = entry;
+		}
+	}
+
+	AllocatorFree(&cache->allocator, cache->buckets);
+	cache->buckets = new_buckets;
+	cache->num_buckets = new_num_buckets;
+}
+
+/* Unlink the entry held by *link from both structures and release it.
+	'kept_key' / 'kept_value' are pointers the cache goes on holding (the ones a Put
+	replaces the entry with), they are passed to release as NULL */
+static void RemoveEntry(lru_cache_t *cache, lru_entry_t **link, const void *kept_key, const void *kept_value)
+{
+	lru_entry_t *entry = *link;
+
+	*link = entry->next;
+	DlistEraseFrom(cache->recency, entry->iter);
+
+	--cache->num_entries;
+	cache->bytes -= entry->bytes;
+
+	if (cache->release != NULL)
+	{
+		cache->release((entry->key == kept_key) ? NULL : entry->key,
+					   (entry->value == kept_value) ? NULL : entry->value, cache->param);
+	}
+
+	AllocatorFree(&cache->allocator, entry);
+}
+
+/* Move entry to the front of the recency list */
+static void Touch(lru_cache_t *cache, lru_entry_t *entry)
+{
+	dlist_iter_t front = DlistBegin(cache->recency);
+
+	if (!DlistIsSameIter(entry->iter, front))
+	{
+		DlistSplice(front, entry->iter, DlistNext(entry->iter));
+	}
+}
+
+/* Evict least recently used entries until the limits are respected */
+static void Evict(lru_cache_t *cache)
+{
+	lru_entry_t *victim = NULL;
+
+	while ((cache->max_entries != 0 && cache->num_entries > cache->max_entries) ||
+		   (cache->max_bytes != 0 && cache->bytes > cache->max_bytes))
+	{
+		victim = (lru_entry_t *)DlistGetData(DlistPrev(DlistEnd(cache->recency)));
+
+		RemoveEntry(cache, EntryLink(cache, victim), NULL, NULL);
+		++cache->stats.evictions;
+	}
+}
+
+/* ************************************************************************************ */
+
+lru_cache_t *LruCacheCreate(size_t max_entries, size_t max_bytes,
+							size_t (*hash)(const void *key, void *param),
+							int (*is_match)(const void *key1, const void *key2, void *param),
+							void (*release)(void *key, void *value, void *param),
+							void *param)
+{
+	return (LruCacheCreateWithAllocator(max_entries, max_bytes, hash, is_match, release, param, NULL));
+}
+
+/* ************************************************************************************ */
+
+lru_cache_t *LruCacheCreateWithAllocator(size_t max_entries, size_t max_bytes,
+										 size_t (*hash)(const void *key, void *param),
+										 int (*is_match)(const void *key1, const void *key2, void *param),
+										 void (*release)(void *key, void *value, void *param),
+										 void *param, const allocator_t *allocator)
+{
+	lru_cache_t *cache = NULL;
+
+	assert(hash != NULL);
+	assert(is_match != NULL);
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	cache = (lru_cache_t *)AllocatorAlloc(allocator, sizeof(lru_cache_t));
+	if (NULL == cache)
+	{
+		return (NULL);
+	}
+
+	cache->allocator = *allocator;
+	cache->recency = DlistCreateWithAllocator(allocator);
+	cache->buckets = AllocBuckets(cache, INIT_NUM_BUCKETS);
+	if (NULL == cache->recency || NULL == cache->buckets)
+	{
+		if (cache->recency != NULL)
+		{
+			DlistDestroy(cache->recency);
+		}
+		AllocatorFree(allocator, cache->buckets);
+		AllocatorFree(allocator, cache);
+		return (NULL);
+	}
+
+	cache->num_buckets = INIT_NUM_BUCKETS;
+	cache->num_entries = 0;
+	cache->bytes = 0;
+	cache->max_entries = max_entries;
+	cache->max_bytes = max_bytes;
+	cache->hash = hash;
+	cache->is_match = is_match;
+	cache->release = release;
+	cache->param = param;
+	LruCacheResetStats(cache);
+
+	return (cache);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(n) ****** */
+void LruCacheDestroy(lru_cache_t *cache)
+{
+	lru_entry_t *entry = NULL;
+
+	assert(cache != NULL);
+
+	while (!DlistIsEmpty(cache->recency))
+	{
+		entry = (lru_entry_t *)DlistPopFront(cache->recency);
+
+		if (cache->release != NULL)
+		{
+			cache->release(entry->key, entry->value, cache->param);
+		}
+
+		AllocatorFree(&cache->allocator, entry);
+	}
+
+	DlistDestroy(cache->recency);
+	AllocatorFree(&cache->allocator, cache->buckets);
+	AllocatorFree(&cache->allocator, cache);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) average ****** */
+int LruCachePut(lru_cache_t *cache, void *key, void *value, size_t bytes)
+{
+	lru_entry_t **link = NULL;
+	lru_entry_t *entry = NULL;
+	size_t hash = 0;
+
+	assert(cache != NULL);
+
+	if (cache->max_bytes != 0 && bytes > cache->max_bytes)
+	{
+		return (1);
+	}
+
+	hash = cache->hash(key, cache->param);
+
+	entry = (lru_entry_t *)AllocatorAlloc(&cache->allocator, sizeof(lru_entry_t));
+	if (NULL == entry)
+	{
+		return (1);
+	}
+
+	entry->iter = DlistPushFront(cache->recency, entry);
+	if (DlistIsSameIter(entry->iter, DlistEnd(cache->recency)))
+	{
+		AllocatorFree(&cache->allocator, entry);
+		return (1);
+	}
+
+	entry->key = key;
+	entry->value = value;
+	entry->bytes = bytes;
+	entry->hash = hash;
+
+	/* replace only after the new entry was allocated */
+	link = FindLink(cache, key, hash);
+	if (*link != NULL)
+	{
+		RemoveEntry(cache, link, key, value);
+	}
+
+	if (cache->num_entries >= cache->num_buckets)
+	{
+		GrowBuckets(cache);
+	}
+
+	link = &cache->buckets[hash & (cache->num_buckets - 1)];
+	entry->next = *link;
+	*link = entry;
+
+	++cache->num_entries;
+	cache->bytes += bytes;
+
+	Evict(cache);
+
+	return (0);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) average ****** */
+void *LruCacheGet(lru_cache_t *cache, const void *key)
+{
+	lru_entry_t *entry = NULL;
+
+	assert(cache != NULL);
+
+	entry = *FindLink(cache, key, cache->hash(key, cache->param));
+	if (NULL == entry)
+	{
+		++cache->stats.misses;
+		return (NULL);
+	}
+
+	++cache->stats.hits;
+	Touch(cache, entry);
+
+	return (entry->value);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) average ****** */
+int LruCacheRemove(lru_cache_t *cache, const void *key)
+{
+	lru_entry_t **link = NULL;
+
+	assert(cache != NULL);
+
+	link = FindLink(cache, key, cache->hash(key, cache->param));
+	if (NULL == *link)
+	{
+		return (1);
+	}
+
+	RemoveEntry(cache, link, NULL, NULL);
+
+	return (0);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t LruCacheSize(const lru_cache_t *cache)
+{
+	assert(cache != NULL);
+
+	return (cache->num_entries);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t LruCacheBytes(const lru_cache_t *cache)
+{
+	assert(cache != NULL);
+
+	return (cache->bytes);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void LruCacheGetStats(const lru_cache_t *cache, lru_stats_t *stats)
+{
+	assert(cache != NULL);
+	assert(stats != NULL);
+
+	*stats = cache->stats;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void LruCacheResetStats(lru_cache_t *cache)
+{
+	assert(cache != NULL);
+
+	cache->stats.hits = 0;
+	cache->stats.misses = 0;
+	cache->stats.evictions = 0;
+}
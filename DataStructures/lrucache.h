@@ -0,0 +1,71 @@
+#ifndef LRUCACHE_H_
+#define LRUCACHE_H_
+
+#include <stddef.h> /* size_t */
+
+#include "allocator.h"
+
+/* LRU cache: a hash map from key to dlist_iter_t, plus a dlist_t ordered from
+	most to least recently used. A hit is moved to the front with DlistSplice,
+	so Get, Put and Remove are O(1) on average. */
+
+typedef struct lru_cache_st lru_cache_t;
+
+typedef struct lru_stats_st lru_stats_t;
+
+struct lru_stats_st
+{
+	size_t hits;
+	size_t misses;
+	size_t evictions;	/* entries dropped to respect the limits */
+};
+
+/* Returns pointer to a new cache, NULL on failure.
+	max_entries / max_bytes: limits on number of entries and on the sum of their 'bytes', 0 for no limit.
+	hash: hash of a key, keys that match must have the same hash.
+	is_match: returns non 0 if the two keys are equal.
+	release: optional (may be NULL), called with key and value whenever an entry leaves
+	the cache - evicted, replaced by Put, removed, or on LruCacheDestroy.
+	When Put replaces an entry and passes the same key (or value) pointer again, the
+	cache keeps holding it, so release gets NULL in its place.
+	Note: must be released by using LruCacheDestroy. */
+lru_cache_t *LruCacheCreate(size_t max_entries, size_t max_bytes,
+							size_t (*hash)(const void *key, void *param),
+							int (*is_match)(const void *key1, const void *key2, void *param),
+							void (*release)(void *key, void *value, void *param),
+							void *param);
+
+/* Same as LruCacheCreate, the cache, its entries and its lists are allocated through
+	'allocator' (NULL for the default malloc/free) */
+lru_cache_t *LruCacheCreateWithAllocator(size_t max_entries, size_t max_bytes,
+										 size_t (*hash)(const void *key, void *param),
+										 int (*is_match)(const void *key1, const void *key2, void *param),
+										 void (*release)(void *key, void *value, void *param),
+										 void *param, const allocator_t *allocator);
+
+/* Destroy the cache, passing every entry to release */
+void LruCacheDestroy(lru_cache_t *cache);
+
+/* Insert key -> value as the most recently used entry, replacing an existing value of key.
+	'bytes' is the size charged against max_bytes.
+	Returns 0 for success and 1 for failure (no memory, or bytes larger than max_bytes) */
+int LruCachePut(lru_cache_t *cache, void *key, void *value, size_t bytes);
+
+/* Returns the value of key and marks it most recently used, NULL if key is not cached */
+void *LruCacheGet(lru_cache_t *cache, const void *key);
+
+/* Remove key from the cache. Returns 0 if it was removed, 1 if it wasn't found */
+int LruCacheRemove(lru_cache_t *cache, const void *key);
+
+/* returns number of entries */
+size_t LruCacheSize(const lru_cache_t *cache);
+
+/* returns the sum of 'bytes' of all entries */
+size_t LruCacheBytes(const lru_cache_t *cache);
+
+/* Copy hit/miss/eviction counters to stats */
+void LruCacheGetStats(const lru_cache_t *cache, lru_stats_t *stats);
+
+void LruCacheResetStats(lru_cache_t *cache);
+
+#endif   /*   LRUCACHE_H_    */
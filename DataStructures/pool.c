@@ -0,0 +1,365 @@
+/* The free stack stores pointers to slots (element_size = sizeof(void *)).
+	Slot size is rounded up to SLOT_ALIGN so every object is suitably aligned
+	for any of the containers' node types. */
+
+#include <stdlib.h>		/* malloc, free */
+#include <string.h>		/* memset */
+#include <assert.h>
+#include <pthread.h>
+
+#include "stack.h"
+#include "pool.h"
+
+#define SLOT_ALIGN (2 * sizeof(void *))
+
+struct pool_st
+{
+	stack_t *free_slots;
+	pthread_mutex_t lock;
+	size_t obj_size;
+	size_t slot_size;
+	size_t count;
+	char *slab;				/* count * slot_size bytes */
+};
+
+struct pool_cache_st
+{
+	pool_t *pool;
+	stack_t *free_slots;
+	size_t capacity;
+};
+
+/* ************************************************************************************ */
+
+static void PushSlot(stack_t *stack, void *obj)
+{
+	int status = StackPush(stack, &obj);
+
+	/* every stack has room for all the objects it can hold */
+	assert(0 == status);
+	(void)status;
+}
+
+static void *PopSlot(stack_t *stack)
+{
+	void *obj = *(void **)StackPeek(stack);
+
+	StackPop(stack);
+
+	return (obj);
+}
+
+static int IsInSlab(const pool_t *pool, const void *obj)
+{
+	const char *ptr = (const char *)obj;
+
+	return (ptr >= pool->slab && ptr < pool->slab + pool->count * pool->slot_size);
+}
+
+#ifndef NDEBUG
+static int IsPoolObject(const pool_t *pool, const void *obj)
+{
+	return (IsInSlab(pool, obj) &&
+			0 == (size_t)((const char *)obj - pool->slab) % pool->slot_size);
+}
+
+static int IsPoisoned(const pool_t *pool, const void *obj)
+{
+	const unsigned char *ptr = (const unsigned char *)obj;
+	size_t i = 0;
+
+	for (i = 0; i < pool->obj_size; ++i)
+	{
+		if (ptr[i] != POOL_POISON)
+		{
+			return (0);
+		}
+	}
+
+	return (1);
+}
+#endif
+
+/* Debug checks on an object leaving the free slots */
+static void *CheckedAlloc(const pool_t *pool, void *obj)
+{
+	assert(IsPoolObject(pool, obj));
+	assert(IsPoisoned(pool, obj));	/* written after it was freed */
+	(void)pool;
+
+	return (obj);
+}
+
+/* Debug checks on an object entering the free slots */
+static void *CheckedFree(const pool_t *pool, void *obj)
+{
+	assert(IsPoolObject(pool, obj));
+#ifndef NDEBUG
+	memset(obj, POOL_POISON, pool->obj_size);
+#endif
+	(void)pool;
+
+	return (obj);
+}
+
+/* Objects that don't fit a slot (e.g. the containers themselves) come from malloc */
+static void *AllocatorPoolAlloc(size_t size, void *context)
+{
+	pool_t *pool = (pool_t *)context;
+
+	if (size > pool->obj_size)
+	{
+		return (malloc(size));
+	}
+
+	return (PoolAlloc(pool));
+}
+
+static void AllocatorPoolFree(void *ptr, void *context)
+{
+	pool_t *pool = (pool_t *)context;
+
+	if (NULL == ptr || !IsInSlab(pool, ptr))
+	{
+		free(ptr);
+		return;
+	}
+
+	PoolFree(pool, ptr);
+}
+
+/* ************************************************************************************ */
+
+pool_t *PoolCreate(size_t count, size_t obj_size)
+{
+	pool_t *pool = NULL;
+	size_t i = 0;
+
+	assert(count > 0);
+	assert(obj_size > 0);
+
+	pool = (pool_t *)malloc(sizeof(pool_t));
+	if (NULL == pool)
+	{
+		return (NULL);
+	}
+
+	pool->obj_size = obj_size;
+	pool->slot_size = (obj_size + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+	pool->count = count;
+
+	pool->slab = (char *)malloc(count * pool->slot_size);
+	pool->free_slots = StackCreate(count, sizeof(void *));
+	if (NULL == pool->slab || NULL == pool->free_slots)
+	{
+		if (pool->free_slots != NULL)
+		{
+			StackDestroy(pool->free_slots);
+		}
+		free(pool->slab);
+		free(pool);
+		return (NULL);
+	}
+
+	pthread_mutex_init(&pool->lock, NULL);
+
+	/* push in reverse so the first allocations come from the start of the slab */
+	for (i = count; i > 0; --i)
+	{
+		PushSlot(pool->free_slots, CheckedFree(pool, pool->slab + (i - 1) * pool->slot_size));
+	}
+
+	return (pool);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void PoolDestroy(pool_t *pool)
+{
+	assert(pool != NULL);
+
+	pthread_mutex_destroy(&pool->lock);
+	StackDestroy(pool->free_slots);
+	free(pool->slab);
+	free(pool);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void *PoolAlloc(pool_t *pool)
+{
+	void *obj = NULL;
+
+	assert(pool != NULL);
+
+	pthread_mutex_lock(&pool->lock);
+	if (StackSize(pool->free_slots) > 0)
+	{
+		obj = PopSlot(pool->free_slots);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return ((NULL == obj) ? NULL : CheckedAlloc(pool, obj));
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void PoolFree(pool_t *pool, void *obj)
+{
+	assert(pool != NULL);
+
+	if (NULL == obj)
+	{
+		return;
+	}
+
+	CheckedFree(pool, obj);
+
+	pthread_mutex_lock(&pool->lock);
+	PushSlot(pool->free_slots, obj);
+	pthread_mutex_unlock(&pool->lock);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t PoolAvailable(pool_t *pool)
+{
+	size_t available = 0;
+
+	assert(pool != NULL);
+
+	pthread_mutex_lock(&pool->lock);
+	available = StackSize(pool->free_slots);
+	pthread_mutex_unlock(&pool->lock);
+
+	return (available);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void PoolAllocatorInit(pool_t *pool, allocator_t *allocator)
+{
+	assert(pool != NULL);
+	assert(allocator != NULL);
+
+	allocator->alloc = AllocatorPoolAlloc;
+	allocator->free = AllocatorPoolFree;
+	allocator->context = pool;
+
+	return;
+}
+
+/* ************************************************************************************ */
+
+pool_cache_t *PoolCacheCreate(pool_t *pool, size_t capacity)
+{
+	pool_cache_t *cache = NULL;
+
+	assert(pool != NULL);
+	assert(capacity > 1);
+
+	cache = (pool_cache_t *)malloc(sizeof(pool_cache_t));
+	if (NULL == cache)
+	{
+		return (NULL);
+	}
+
+	cache->free_slots = StackCreate(capacity, sizeof(void *));
+	if (NULL == cache->free_slots)
+	{
+		free(cache);
+		return (NULL);
+	}
+
+	cache->pool = pool;
+	cache->capacity = capacity;
+
+	return (cache);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(capacity) ****** */
+void PoolCacheDestroy(pool_cache_t *cache)
+{
+	pool_t *pool = NULL;
+
+	assert(cache != NULL);
+
+	pool = cache->pool;
+
+	pthread_mutex_lock(&pool->lock);
+	while (StackSize(cache->free_slots) > 0)
+	{
+		PushSlot(pool->free_slots, PopSlot(cache->free_slots));
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	StackDestroy(cache->free_slots);
+	free(cache);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) amortized ****** */
+void *PoolCacheAlloc(pool_cache_t *cache)
+{
+	pool_t *pool = NULL;
+
+	assert(cache != NULL);
+
+	pool = cache->pool;
+
+	if (0 == StackSize(cache->free_slots))
+	{
+		/* refill half of the cache in one locked batch */
+		pthread_mutex_lock(&pool->lock);
+		while (StackSize(cache->free_slots) < cache->capacity / 2 && StackSize(pool->free_slots) > 0)
+		{
+			PushSlot(cache->free_slots, PopSlot(pool->free_slots));
+		}
+		pthread_mutex_unlock(&pool->lock);
+
+		if (0 == StackSize(cache->free_slots))
+		{
+			return (NULL);
+		}
+	}
+
+	return (CheckedAlloc(pool, PopSlot(cache->free_slots)));
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) amortized ****** */
+void PoolCacheFree(pool_cache_t *cache, void *obj)
+{
+	pool_t *pool = NULL;
+
+	assert(cache != NULL);
+
+	if (NULL == obj)
+	{
+		return;
+	}
+
+	pool = cache->pool;
+
+	if (StackSize(cache->free_slots) == cache->capacity)
+	{
+		/* flush half of the cache in one locked batch */
+		pthread_mutex_lock(&pool->lock);
+		while (StackSize(cache->free_slots) > cache->capacity / 2)
+		{
+			PushSlot(pool->free_slots, PopSlot(cache->free_slots));
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	PushSlot(cache->free_slots, CheckedFree(pool, obj));
+
+	return;
+}
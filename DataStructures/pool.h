@@ -0,0 +1,57 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+
+#include "allocator.h"
+
+/* Fixed-size object pool.
+	'count' slots of 'obj_size' bytes are allocated once; a stack_t holds the
+	free slots, so PoolAlloc and PoolFree are O(1) pops and pushes.
+	The pool is thread safe (one mutex). A thread that allocates a lot can use
+	a pool_cache_t: a private stack of free slots refilled from / flushed to
+	the pool in batches, so most calls take no lock.
+	Unless NDEBUG is defined, freed objects are filled with POOL_POISON and
+	checked on allocation to catch writes after free. */
+
+#define POOL_POISON (0xDE)
+
+typedef struct pool_st pool_t;
+
+typedef struct pool_cache_st pool_cache_t;
+
+/* Returns pointer to a new pool of 'count' objects of 'obj_size' bytes, NULL on failure.
+	Note: must be released by using PoolDestroy. */
+pool_t *PoolCreate(size_t count, size_t obj_size);
+
+/* Destroy the pool and all its objects, all caches must be destroyed first */
+void PoolDestroy(pool_t *pool);
+
+/* Returns a free object, NULL if the pool is exhausted */
+void *PoolAlloc(pool_t *pool);
+
+/* Return obj (allocated from pool) to the pool */
+void PoolFree(pool_t *pool, void *obj);
+
+/* returns number of free objects in the pool (not counting objects held by caches) */
+size_t PoolAvailable(pool_t *pool);
+
+/* Fill 'allocator' so that containers allocate their nodes from pool.
+	Allocations larger than the pool's object size (such as the container
+	structs) are served by malloc; free tells them apart by address. */
+void PoolAllocatorInit(pool_t *pool, allocator_t *allocator);
+
+/* Returns a cache of up to 'capacity' free objects for one thread, NULL on failure.
+	Note: must be released by using PoolCacheDestroy. */
+pool_cache_t *PoolCacheCreate(pool_t *pool, size_t capacity);
+
+/* Return the cached objects to the pool and destroy the cache */
+void PoolCacheDestroy(pool_cache_t *cache);
+
+/* Returns a free object, NULL if the cache and the pool are exhausted */
+void *PoolCacheAlloc(pool_cache_t *cache);
+
+/* Return obj (allocated from the cache's pool) through the cache */
+void PoolCacheFree(pool_cache_t *cache, void *obj);
+
+#endif /* POOL_H_ */
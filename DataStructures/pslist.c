@@ -0,0 +1,136 @@
+/* Each node counts the references to it: one per owning pslist_t pointer held
+	by the user, plus one per node whose 'next' points to it.
+	Releasing a node that drops to 0 frees it and releases its 'next' in turn,
+	which is done iteratively so long lists don't recurse. */
+
+#include <stdlib.h>		/* malloc, free */
+#include <assert.h>
+
+#include "pslist.h"
+
+struct pslist_node_st
+{
+	void *data;
+	pslist_t *next;
+	size_t ref_count;
+};
+
+/*  **** Complexity: O(1) ****** */
+pslist_t *PSListPushFront(pslist_t *list, void *data)
+{
+	pslist_t *new_node = NULL;
+
+	new_node = (pslist_t *)malloc(sizeof(pslist_t));
+	if (NULL == new_node)
+	{
+		return (NULL);
+	}
+
+	new_node->data = data;
+	new_node->next = PSListRetain(list);	/* the new node shares 'list' */
+	new_node->ref_count = 1;
+
+	return (new_node);
+}
+
+/*  **** Complexity: O(1) ****** */
+pslist_t *PSListRetain(pslist_t *list)
+{
+	if (list != NULL)
+	{
+		__atomic_add_fetch(&list->ref_count, 1, __ATOMIC_RELAXED);
+	}
+
+	return (list);
+}
+
+/*  **** Complexity: O(freed nodes) ****** */
+void PSListRelease(pslist_t *list)
+{
+	pslist_t *next = NULL;
+
+	while (list != NULL && 0 == __atomic_sub_fetch(&list->ref_count, 1, __ATOMIC_ACQ_REL))
+	{
+		next = list->next;
+		free(list);
+		list = next;
+	}
+
+	return;
+}
+
+/*  **** Complexity: O(1) ****** */
+pslist_t *PSListPopFront(pslist_t *list)
+{
+	pslist_t *tail = NULL;
+
+	assert(list != NULL);
+
+	tail = PSListRetain(list->next);
+	PSListRelease(list);
+
+	return (tail);
+}
+
+/*  **** Complexity: O(1) ****** */
+void *PSListHead(const pslist_t *list)
+{
+	assert(list != NULL);
+
+	return (list->data);
+}
+
+/*  **** Complexity: O(1) ****** */
+pslist_t *PSListTail(const pslist_t *list)
+{
+	assert(list != NULL);
+
+	return (list->next);
+}
+
+/*  **** Complexity: O(n) ****** */
+size_t PSListCount(const pslist_t *list)
+{
+	size_t count = 0;
+
+	for (; list != NULL; list = list->next)
+	{
+		++count;
+	}
+
+	return (count);
+}
+
+/*  **** Complexity: O(n) ****** */
+pslist_t *PSListFind(const pslist_t *list, int (*is_match)(const void *node_data, const void *data, void *param), const void *data, void *param)
+{
+	assert(is_match != NULL);
+
+	while (list != NULL && !(is_match(list->data, data, param)))
+	{
+		list = list->next;
+	}
+
+	return ((pslist_t *)list);
+}
+
+/*  **** Complexity: O(n) ****** */
+int PSListForEach(const pslist_t *list, int (*func)(void *node_data, void *param), void *param)
+{
+	int func_ret_val = 0;
+
+	assert(func != NULL);
+
+	while (list != NULL)
+	{
+		func_ret_val = func(list->data, param);
+		if (func_ret_val != 0)
+		{
+			return (func_ret_val);
+		}
+
+		list = list->next;
+	}
+
+	return (0);
+}
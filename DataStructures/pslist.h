@@ -0,0 +1,46 @@
+#ifndef PSLIST_H_
+#define PSLIST_H_
+
+#include <stddef.h>
+
+/* Persistent (immutable) singly linked list with shared, reference counted nodes.
+	A list is a pointer to its first node, NULL is the empty list.
+	Nodes are never modified after creation: pushing to a list creates a new head
+	that shares the old list as its tail, so a "copy" or a snapshot is O(1).
+	Every pslist_t pointer returned by PSListPushFront, PSListRetain or
+	PSListPopFront is an owning reference that must be dropped with PSListRelease.
+	Reference counts are atomic, so snapshots may be released by other threads.
+	Nodes use malloc/free rather than an allocator_t: a node shared by many lists
+	is freed by whichever of them drops the last reference. */
+
+typedef struct pslist_node_st pslist_t;
+
+/* Returns a new list: data followed by 'list', NULL upon failure.
+	The caller's reference to 'list' stays valid and must still be released. */
+pslist_t *PSListPushFront(pslist_t *list, void *data);
+
+/* Returns another reference to 'list' (an O(1) snapshot) */
+pslist_t *PSListRetain(pslist_t *list);
+
+/* Drop a reference. Nodes no other list shares are freed */
+void PSListRelease(pslist_t *list);
+
+/* Returns the list without its first node, consuming the reference to 'list' */
+pslist_t *PSListPopFront(pslist_t *list);
+
+/* returns data of the first node, list must not be empty */
+void *PSListHead(const pslist_t *list);
+
+/* returns the list without its first node, as a borrowed reference (valid while 'list' is) */
+pslist_t *PSListTail(const pslist_t *list);
+
+/* Return the numbers of nodes in the list */
+size_t PSListCount(const pslist_t *list);
+
+/* Returns the first sub-list whose head matches data (a borrowed reference), NULL if none */
+pslist_t *PSListFind(const pslist_t *list, int (*is_match)(const void *node_data, const void *data, void *param), const void *data, void *param);
+
+/* Send the data from each node to func, along with param. Stops in case func fails, and Returns the the value of the last call to func. */
+int PSListForEach(const pslist_t *list, int (*func)(void *node_data, void *param), void *param);
+
+#endif /* PSLIST_H_ */
@@ -1,57 +1,115 @@
-#include <stdlib.h> /* malloc, free */
 #include <assert.h> 
 
 #include "slist.h" 
 #include "queue.h"
+#include "queue_inline.h"	/* queue layout */
 
-struct queue_st
+#define INLINE_MASK (QUEUE_INLINE_CAPACITY - 1)
+
+/*********************************/
+static void *InlineAt(const queue_t *queue, size_t index)
+{
+	return (queue->inline_data[(queue->inline_first + index) & INLINE_MASK]);
+}
+/*********************************/
+static void InlinePush(queue_t *queue, void *data)
 {
-	slist_node_t *head;		/* first node of the queue */
-	slist_node_t *tail;		/* last node of the queue */
-};
+	assert(queue->inline_count < QUEUE_INLINE_CAPACITY);
 
+	queue->inline_data[(queue->inline_first + queue->inline_count) & INLINE_MASK] = data;
+	++queue->inline_count;
+}
+/*********************************/
+/* Link the chain head..tail of 'count' nodes after the last node of queue */
+static void LinkNodes(queue_t *queue, slist_node_t *head, slist_node_t *tail, size_t count)
+{
+	if (NULL == queue->tail)
+	{
+		queue->head = head;
+		queue->tail = tail;
+	}
+	else
+	{
+		queue->tail = SListConcat(queue->tail, head, tail);
+	}
+	
+	queue->num_nodes += count;
+}
+/*********************************/
 queue_t *QueueCreate(void)
+{
+	return (QueueCreateWithAllocator(NULL));
+}
+/*********************************/
+queue_t *QueueCreateWithAllocator(const allocator_t *allocator)
 {
 	queue_t *queue = NULL;
-	slist_node_t *dummy = NULL;
 	
-	queue = (queue_t *)malloc(sizeof(queue_t));
-	if (NULL == queue)
+	if (NULL == allocator)
 	{
-		return (NULL);
+		allocator = AllocatorDefault();
 	}
 	
-	dummy = SListCreateAndInitNode(NULL, NULL);
-	if (dummy == NULL)
+	queue = (queue_t *)AllocatorAlloc(allocator, sizeof(queue_t));
+	if (NULL == queue)
 	{
-		free(queue);
 		return (NULL);
 	}
 	
-	queue->head = dummy;
-	queue->tail = dummy;
+	QueueInit(queue, allocator);
 	
 	return(queue);
 }	
 /*********************************/
+/*  **** Complexity: O(1) ****** */
+void QueueInit(queue_t *queue, const allocator_t *allocator)
+{
+	assert(queue != NULL);
+	
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+	
+	queue->allocator = *allocator;
+	
+	queue->inline_first = 0;
+	queue->inline_count = 0;
+	queue->head = NULL;
+	queue->tail = NULL;
+	queue->num_nodes = 0;
+	
+	return;
+}
+/*********************************/
 /*  **** Complexity: O(n) ****** */
 void QueueDestroy(queue_t *queue)
 {
 	assert(queue != NULL);
 
-	SListFreeAll(queue->head);	/*  frees also dummy */
+	QueueDeinit(queue);
 
-	free(queue);
+	AllocatorFree(&queue->allocator, queue);
 	
 	return;
 }
 /*********************************/
 /*  **** Complexity: O(n) ****** */
+void QueueDeinit(queue_t *queue)
+{
+	assert(queue != NULL);
+
+	SListFreeAllWithAllocator(queue->head, &queue->allocator);
+	
+	return;
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
 size_t QueueSize(const queue_t *queue)
 {
 	assert(queue != NULL);
 			
-	return (SListCount(queue->head) - 1); /* decrease dummy element */
+	return (queue->inline_count + queue->num_nodes);
 }
 /*********************************/
 /*  **** Complexity: O(1) ****** */
@@ -59,7 +117,7 @@ int QueueIsEmpty(const queue_t *queue)
 {
 	assert(queue != NULL);
 	
-	return (queue->head == queue->tail);
+	return (0 == queue->inline_count && NULL == queue->head);
 }
 /*********************************/
 /*  **** Complexity: O(1) ****** */
@@ -69,14 +127,19 @@ int QueueEnqueue(queue_t *queue, void *data)
 	
 	assert(queue != NULL);
 	
-	new_node = SListCreateAndInitNode(data, NULL);
+	if (NULL == queue->head && queue->inline_count < QUEUE_INLINE_CAPACITY)
+	{
+		InlinePush(queue, data);
+		return (0);
+	}
+	
+	new_node = SListCreateAndInitNodeWithAllocator(data, NULL, &queue->allocator);
 	if (NULL == new_node)
 	{
 		return (1);
 	}
 	
-	/* Update tail to point on dummy */
-	queue->tail = (SListInsert(queue->tail, new_node))->next;
+	LinkNodes(queue, new_node, new_node, 1);
 
 	return (0);
 }
@@ -89,22 +152,33 @@ void *QueueDequeue(queue_t *queue)
 		
 	assert(queue != NULL);
 	
-	if (QueueIsEmpty(queue))
+	if (queue->inline_count > 0)
+	{
+		ret_data = InlineAt(queue, 0);
+		queue->inline_first = (queue->inline_first + 1) & INLINE_MASK;
+		--queue->inline_count;
+		
+		return (ret_data);
+	}
+	
+	if (NULL == queue->head)
 	{
 		return (NULL);
 	}
-		
-	ret_data = queue->head->data;
-
-	removed_node = SListRemove(queue->head);
 	
-	/* update tail if last element was removed */
-	if (removed_node == queue->tail)
+	removed_node = queue->head;
+	ret_data = removed_node->data;
+	
+	queue->head = removed_node->next;
+	--queue->num_nodes;
+	
+	/* update tail if last node was removed */
+	if (NULL == queue->head)
 	{
-		queue->tail = queue->head;
+		queue->tail = NULL;
 	}
 	
-	free(removed_node);
+	AllocatorFree(&queue->allocator, removed_node);
 	
 	return (ret_data);
 }
@@ -114,7 +188,12 @@ void *QueuePeek(const queue_t *queue)
 {
 	assert(queue != NULL);
 
-	if (QueueIsEmpty(queue))
+	if (queue->inline_count > 0)
+	{
+		return (InlineAt(queue, 0));
+	}
+	
+	if (NULL == queue->head)
 	{
 		return (NULL);
 	}
@@ -122,31 +201,74 @@ void *QueuePeek(const queue_t *queue)
 	return ((queue->head)->data);
 }
 /*********************************/
-/*  **** Complexity: O(1) ****** */
-void QueueAppend(queue_t *to, queue_t *from)
+/*  **** Complexity: O(QUEUE_INLINE_CAPACITY) ****** */
+int QueueAppend(queue_t *to, queue_t *from)
 {
-	slist_node_t *dummy = NULL;
+	slist_node_t *spill_head = NULL;
+	slist_node_t *spill_tail = NULL;
+	slist_node_t *new_node = NULL;
+	size_t num_moved = 0;
+	size_t i = 0;
 		
-	/* connect tail of 'to' queue to head of 'from' queue */
-	/* Then empty 'from', using the removed dummy node of 'to' */  
+	/* inline elements of 'from' move to the ring of 'to' while it has room
+		(and no nodes), the rest get nodes. The nodes of 'from' are linked after them */
 
 	assert(to != NULL);
 	assert(from != NULL);
+	assert(AllocatorIsSame(&to->allocator, &from->allocator));
 
-	if (!QueueIsEmpty(from))
+	if (QueueIsEmpty(from))
 	{
-		(to->tail)->next = from->head;
-
-		dummy = SListRemove(to->tail);
+		return (0);
+	}
 	
-		dummy->data = NULL;
-		dummy->next = NULL;
-
-		to->tail = from->tail;
-		from->head = from->tail = dummy;
-
-	}	
+	if (NULL == to->head)
+	{
+		num_moved = QUEUE_INLINE_CAPACITY - to->inline_count;
+		if (num_moved > from->inline_count)
+		{
+			num_moved = from->inline_count;
+		}
+	}
 	
-	return;
+	/* allocate every node first, so a failure leaves both queues unchanged */
+	for (i = from->inline_count; i > num_moved; --i)
+	{
+		new_node = SListCreateAndInitNodeWithAllocator(InlineAt(from, i - 1), spill_head, &to->allocator);
+		if (NULL == new_node)
+		{
+			SListFreeAllWithAllocator(spill_head, &to->allocator);
+			return (1);
+		}
+		
+		if (NULL == spill_tail)
+		{
+			spill_tail = new_node;
+		}
+		spill_head = new_node;
+	}
+	
+	for (i = 0; i < num_moved; ++i)
+	{
+		InlinePush(to, InlineAt(from, i));
+	}
+	
+	if (spill_head != NULL)
+	{
+		LinkNodes(to, spill_head, spill_tail, from->inline_count - num_moved);
+	}
+	
+	if (from->head != NULL)
+	{
+		LinkNodes(to, from->head, from->tail, from->num_nodes);
+	}
+	
+	from->inline_first = 0;
+	from->inline_count = 0;
+	from->head = NULL;
+	from->tail = NULL;
+	from->num_nodes = 0;
+	
+	return (0);
 }
 
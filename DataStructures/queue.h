@@ -3,6 +3,10 @@
 
 #include <stddef.h> /* size_t */
 
+#include "allocator.h"
+
+/* Number of elements stored inside the queue itself before nodes are allocated (power of 2) */
+#define QUEUE_INLINE_CAPACITY (4)
 
 typedef struct queue_st queue_t;
 
@@ -10,6 +14,10 @@ typedef struct queue_st queue_t;
 	Note:  must be released by using QueueDestroy. */
 queue_t *QueueCreate(void);
 
+/* Same as QueueCreate, the queue and its nodes are allocated through 'allocator'
+	(NULL for the default malloc/free) */
+queue_t *QueueCreateWithAllocator(const allocator_t *allocator);
+
 void QueueDestroy(queue_t *queue);
 
 /* Get number of elements in the queue. */
@@ -28,8 +36,11 @@ void *QueueDequeue(queue_t *queue);
 /* Returns pointer to next element to be dequeued,  NULL if queue empty */
 void *QueuePeek(const queue_t *queue);
 
-/* Append 'from' queue to 'to' queue */
-void QueueAppend(queue_t *to, queue_t *from);
+/* Append 'from' queue to 'to' queue and empty 'from', both must use the same allocator.
+	The nodes of 'from' are spliced in O(1), but its inline elements are copied:
+	O(QUEUE_INLINE_CAPACITY), and the ones that don't fit the ring of 'to' need new nodes.
+	Returns 0 on success, 1 if out of memory (both queues are left unchanged) */
+int QueueAppend(queue_t *to, queue_t *from);
 
 #endif   /*   QUEUE_H_    */
 
@@ -0,0 +1,55 @@
+#ifndef QUEUE_INLINE_H_
+#define QUEUE_INLINE_H_
+
+#include <assert.h>
+
+#include "slist.h"
+#include "queue.h"
+
+/* Opt-in inline version of QueueIsEmpty, for polling loops.
+	Including this header exposes the queue layout: code that uses it must be
+	rebuilt whenever this header changes. Before C99, QueueIsEmptyInline is
+	QueueIsEmpty. */
+
+/* The first elements are kept in a small ring inside the queue itself.
+	Nodes are used only when the ring is full, and once there are nodes every new
+	element goes after them, so the ring always holds the oldest elements.
+	On 64-bit targets everything up to num_nodes fills the first cache line;
+	the allocator, only read when nodes are allocated or freed, starts the second. */
+struct queue_st
+{
+	unsigned int inline_first;	/* ring index of the oldest inline element */
+	unsigned int inline_count;
+	void *inline_data[QUEUE_INLINE_CAPACITY];
+	
+	slist_node_t *head;		/* first node, NULL if there are no nodes */
+	slist_node_t *tail;		/* last node, NULL if there are no nodes */
+	size_t num_nodes;
+	allocator_t allocator;	/* used for the queue and its nodes */
+};
+
+/* Initialize a queue embedded in a bigger struct (so it can share that struct's
+	cache lines), its nodes are allocated through 'allocator' (NULL for malloc/free).
+	Note: must be released by using QueueDeinit, not QueueDestroy. */
+void QueueInit(queue_t *queue, const allocator_t *allocator);
+
+/* Free the nodes of a queue initialized by QueueInit, but not the queue itself */
+void QueueDeinit(queue_t *queue);
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+
+/*  **** Complexity: O(1) ****** */
+static inline int QueueIsEmptyInline(const queue_t *queue)
+{
+	assert(queue != NULL);
+	
+	return (0 == queue->inline_count && NULL == queue->head);
+}
+
+#else /* C89 */
+
+#define QueueIsEmptyInline QueueIsEmpty
+
+#endif /* C99 */
+
+#endif   /*   QUEUE_INLINE_H_    */
@@ -0,0 +1,601 @@
+/* Read-mostly doubly linked list with epoch based reclamation.
+
+	Readers only follow 'next' (acquire loads). Writers hold 'write_lock',
+	update 'next' with release stores in an order that keeps the chain from
+	head to tail intact at every moment, and update 'prev' freely since
+	readers never use it.
+
+	Grace period:
+	'epoch' is a global counter. A reader entering a read section copies it
+	into its slot (0 means outside a read section). An erased node is stamped
+	with the current epoch, then the epoch is incremented. Any reader that
+	started after the increment can't reach the node, so the node can be
+	freed once every active reader slot holds an epoch greater than the stamp. */
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>		/* sched_yield */
+
+#include "rcudlist.h"
+
+#define CACHE_LINE (64)
+#define RECLAIM_THRESHOLD (64)	/* retired nodes before trying to reclaim */
+
+typedef struct rcu_dlist_node_st rcu_dlist_node_t;
+
+struct rcu_dlist_node_st
+{
+	void *data; /*store node data*/
+
+	rcu_dlist_node_t *next;
+	rcu_dlist_node_t *prev;		/* once erased: next node in the retired list */
+	size_t retire_epoch;
+};
+
+struct rcu_dlist_reader_st
+{
+	rcu_dlist_t *dlist;
+	size_t epoch;				/* 0 when outside a read section */
+	int in_use;
+	char pad[CACHE_LINE - sizeof(rcu_dlist_t *) - sizeof(size_t) - sizeof(int)];
+};
+
+struct rcu_dlist_st
+{
+	rcu_dlist_node_t head;
+	rcu_dlist_node_t tail;
+
+	pthread_mutex_t write_lock;
+	size_t epoch;
+	rcu_dlist_node_t *retired;	/* erased nodes, newest first */
+	size_t num_retired;
+	allocator_t allocator;		/* used for the dlist and its nodes */
+
+	rcu_dlist_reader_t readers[RCU_DLIST_MAX_READERS];
+};
+
+/* ************************* */
+/* Publish 'value' in 'link' for readers */
+static void RcuPublish(rcu_dlist_node_t **link, rcu_dlist_node_t *value)
+{
+	__atomic_store_n(link, value, __ATOMIC_RELEASE);
+}
+
+/* Returns the smallest epoch of a reader inside a read section, or 0 if there is none */
+static size_t RcuMinReaderEpoch(const rcu_dlist_t *dlist)
+{
+	size_t min_epoch = 0;
+	size_t epoch = 0;
+	size_t i = 0;
+
+	for (i = 0; i < RCU_DLIST_MAX_READERS; ++i)
+	{
+		epoch = __atomic_load_n(&dlist->readers[i].epoch, __ATOMIC_ACQUIRE);
+		if (epoch != 0 && (0 == min_epoch || epoch < min_epoch))
+		{
+			min_epoch = epoch;
+		}
+	}
+
+	return (min_epoch);
+}
+
+/* Free retired nodes that no reader can hold anymore. Called with write_lock held */
+static void RcuReclaim(rcu_dlist_t *dlist)
+{
+	rcu_dlist_node_t **link = &dlist->retired;
+	rcu_dlist_node_t *node = NULL;
+	size_t min_epoch = 0;
+
+	/* pairs with the fence in RcuDlistReadLock */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	min_epoch = RcuMinReaderEpoch(dlist);
+
+	while (*link != NULL)
+	{
+		node = *link;
+		if (0 == min_epoch || node->retire_epoch < min_epoch)
+		{
+			*link = node->prev;
+			AllocatorFree(&dlist->allocator, node);
+			--dlist->num_retired;
+		}
+		else
+		{
+			link = &node->prev;
+		}
+	}
+}
+
+/* Stamp an unlinked node and queue it for reclamation. Called with write_lock held */
+static void RcuRetire(rcu_dlist_t *dlist, rcu_dlist_node_t *node)
+{
+	node->retire_epoch = dlist->epoch;
+	node->prev = dlist->retired;
+	dlist->retired = node;
+	++dlist->num_retired;
+
+	/* readers that see the new epoch also see the node unlinked */
+	__atomic_add_fetch(&dlist->epoch, 1, __ATOMIC_SEQ_CST);
+
+	if (dlist->num_retired >= RECLAIM_THRESHOLD)
+	{
+		RcuReclaim(dlist);
+	}
+}
+
+/* Called with write_lock held */
+static rcu_dlist_iter_t RcuInsertAfter(rcu_dlist_t *dlist, rcu_dlist_node_t *where, void *data)
+{
+	rcu_dlist_node_t *new_node = NULL;
+
+	assert (where->next != NULL);
+
+	new_node = (rcu_dlist_node_t *)AllocatorAlloc(&dlist->allocator, sizeof(rcu_dlist_node_t));
+	if (NULL == new_node)
+	{
+		return (&dlist->tail);
+	}
+
+	/* fully build the node before a reader can reach it */
+	new_node->data = data;
+	new_node->next = where->next;
+	new_node->prev = where;
+	new_node->retire_epoch = 0;
+
+	RcuPublish(&where->next, new_node);
+	new_node->next->prev = new_node;
+
+	return (new_node);
+}
+
+/* Called with write_lock held */
+static rcu_dlist_iter_t RcuErase(rcu_dlist_t *dlist, rcu_dlist_node_t *iter)
+{
+	rcu_dlist_node_t *next = iter->next;
+
+	/* 'iter->next' stays intact for readers standing on iter */
+	RcuPublish(&iter->prev->next, next);
+	next->prev = iter->prev;
+
+	RcuRetire(dlist, iter);
+
+	return (next);
+}
+
+/* ************************* */
+rcu_dlist_t *RcuDlistCreate(void)
+{
+	return (RcuDlistCreateWithAllocator(NULL));
+}
+
+/* ************************* */
+rcu_dlist_t *RcuDlistCreateWithAllocator(const allocator_t *allocator)
+{
+	rcu_dlist_t *dlist = NULL;
+	size_t i = 0;
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	dlist = (rcu_dlist_t *)AllocatorAlloc(allocator, sizeof(rcu_dlist_t));
+	if (NULL == dlist)
+	{
+		return (NULL);
+	}
+
+	if (0 != pthread_mutex_init(&dlist->write_lock, NULL))
+	{
+		AllocatorFree(allocator, dlist);
+		return (NULL);
+	}
+
+	dlist->allocator = *allocator;
+
+	(dlist->head).data = NULL;
+	(dlist->head).next = &(dlist->tail);
+	(dlist->head).prev = NULL;
+
+	(dlist->tail).data = NULL;
+	(dlist->tail).next = NULL;
+	(dlist->tail).prev = &(dlist->head);
+
+	dlist->epoch = 1;
+	dlist->retired = NULL;
+	dlist->num_retired = 0;
+
+	for (i = 0; i < RCU_DLIST_MAX_READERS; ++i)
+	{
+		dlist->readers[i].dlist = dlist;
+		dlist->readers[i].epoch = 0;
+		dlist->readers[i].in_use = 0;
+	}
+
+	return (dlist);
+}
+
+/* ************************* */
+/*  **** Complexity: O(n) ****** */
+void RcuDlistDestroy(rcu_dlist_t *dlist)
+{
+	rcu_dlist_node_t *node = NULL;
+	rcu_dlist_node_t *next = NULL;
+
+	assert (dlist != NULL);
+	assert (0 == RcuMinReaderEpoch(dlist));
+
+	for (node = (dlist->head).next; node != &(dlist->tail); node = next)
+	{
+		next = node->next;
+		AllocatorFree(&dlist->allocator, node);
+	}
+
+	for (node = dlist->retired; node != NULL; node = next)
+	{
+		next = node->prev;
+		AllocatorFree(&dlist->allocator, node);
+	}
+
+	pthread_mutex_destroy(&dlist->write_lock);
+	AllocatorFree(&dlist->allocator, dlist);
+
+	return;
+}
+
+/* ************************** */
+/* **** Complexity: O(RCU_DLIST_MAX_READERS) **** */
+rcu_dlist_reader_t *RcuDlistReaderRegister(rcu_dlist_t *dlist)
+{
+	int expected = 0;
+	size_t i = 0;
+
+	assert (dlist != NULL);
+
+	for (i = 0; i < RCU_DLIST_MAX_READERS; ++i)
+	{
+		expected = 0;
+		if (__atomic_compare_exchange_n(&dlist->readers[i].in_use, &expected, 1, 0,
+										__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			return (&dlist->readers[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+void RcuDlistReaderUnregister(rcu_dlist_reader_t *reader)
+{
+	assert (reader != NULL);
+	assert (0 == reader->epoch);
+
+	__atomic_store_n(&reader->in_use, 0, __ATOMIC_RELEASE);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+void RcuDlistReadLock(rcu_dlist_reader_t *reader)
+{
+	assert (reader != NULL);
+	assert (0 == reader->epoch);
+
+	__atomic_store_n(&reader->epoch,
+					__atomic_load_n(&reader->dlist->epoch, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+
+	/* make the slot visible before the first link is read, pairs with RcuReclaim */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+void RcuDlistReadUnlock(rcu_dlist_reader_t *reader)
+{
+	assert (reader != NULL);
+	assert (reader->epoch != 0);
+
+	__atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistBegin(const rcu_dlist_t *dlist)
+{
+	assert (dlist != NULL);
+
+	return (__atomic_load_n(&(dlist->head).next, __ATOMIC_ACQUIRE));
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistEnd(const rcu_dlist_t *dlist)
+{
+	assert (dlist != NULL);
+
+	return ((rcu_dlist_iter_t)&(dlist->tail));
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+int RcuDlistIsSameIter(rcu_dlist_iter_t iter_1, rcu_dlist_iter_t iter_2)
+{
+	assert (iter_1 != NULL);
+	assert (iter_2 != NULL);
+
+	return (iter_1 == iter_2);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistNext(rcu_dlist_iter_t iter)
+{
+	rcu_dlist_iter_t next = NULL;
+
+	assert (iter != NULL);
+
+	next = __atomic_load_n(&iter->next, __ATOMIC_ACQUIRE);
+	assert (next != NULL);
+
+	return (next);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+void *RcuDlistGetData(rcu_dlist_iter_t where)
+{
+	assert (where != NULL);
+
+	return (where->data);
+}
+
+/* ************************* */
+/*  **** Complexity: O(n) ****** */
+size_t RcuDlistSize(const rcu_dlist_t *dlist)
+{
+	size_t count = 0;
+	rcu_dlist_iter_t curr = NULL;
+	rcu_dlist_iter_t end = NULL;
+
+	assert (dlist != NULL);
+
+	curr = RcuDlistBegin(dlist);
+	end = RcuDlistEnd(dlist);
+
+	for (; !RcuDlistIsSameIter(curr, end); curr = RcuDlistNext(curr))
+	{
+		++count;
+	}
+
+	return (count);
+}
+
+/* ************************* */
+/*  **** Complexity: O(1) ****** */
+int RcuDlistIsEmpty(const rcu_dlist_t *dlist)
+{
+	assert (dlist != NULL);
+
+	return (RcuDlistIsSameIter(RcuDlistBegin(dlist), RcuDlistEnd(dlist)));
+}
+
+/* ************************** */
+/* **** Complexity: O(n) **** */
+rcu_dlist_iter_t RcuDlistFind(rcu_dlist_iter_t from,
+							rcu_dlist_iter_t to,
+							int (*is_match)
+								(const void *node_data,
+								const void *data,
+								void *param),
+							const void *data,
+							void *param)
+{
+	rcu_dlist_iter_t curr = from;
+
+	assert(from != NULL);
+	assert(to != NULL);
+	assert(is_match != NULL);
+
+	while (!RcuDlistIsSameIter(curr, to) && !is_match(RcuDlistGetData(curr), data, param))
+	{
+		curr = RcuDlistNext(curr);
+	}
+
+	return (curr);
+}
+
+/* ************************** */
+/* **** Complexity: O(n) **** */
+int RcuDlistForEach(rcu_dlist_iter_t from, rcu_dlist_iter_t to,
+					int (*func)
+					(void *node_data,
+					void *param),
+					void *param)
+{
+	rcu_dlist_iter_t curr = from;
+	int ret_func = 0;
+
+	assert(from != NULL);
+	assert(to != NULL);
+	assert(func != NULL);
+
+	while (!RcuDlistIsSameIter(curr, to) && !(ret_func = func(RcuDlistGetData(curr), param)))
+	{
+		curr = RcuDlistNext(curr);
+	}
+
+	return (ret_func);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistInsert(rcu_dlist_t *dlist, rcu_dlist_iter_t where, void *data)
+{
+	rcu_dlist_iter_t ret_iter = NULL;
+
+	assert (dlist != NULL);
+	assert (where != NULL);
+	assert (where->prev != NULL);
+
+	pthread_mutex_lock(&dlist->write_lock);
+	ret_iter = RcuInsertAfter(dlist, where->prev, data);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (ret_iter);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistInsertAfter(rcu_dlist_t *dlist, rcu_dlist_iter_t where, void *data)
+{
+	rcu_dlist_iter_t ret_iter = NULL;
+
+	assert (dlist != NULL);
+	assert (where != NULL);
+
+	pthread_mutex_lock(&dlist->write_lock);
+	ret_iter = RcuInsertAfter(dlist, where, data);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (ret_iter);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistPushBack(rcu_dlist_t *dlist, void *data)
+{
+	assert (dlist != NULL);
+
+	return (RcuDlistInsert(dlist, RcuDlistEnd(dlist), data));
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistPushFront(rcu_dlist_t *dlist, void *data)
+{
+	assert (dlist != NULL);
+
+	return (RcuDlistInsertAfter(dlist, &(dlist->head), data));
+}
+
+/* ************************** */
+/* **** Complexity: O(1) amortized **** */
+rcu_dlist_iter_t RcuDlistErase(rcu_dlist_t *dlist, rcu_dlist_iter_t iter)
+{
+	rcu_dlist_iter_t ret_iter = NULL;
+
+	assert (dlist != NULL);
+	assert (iter != NULL);
+	assert (iter->next != NULL);
+	assert (iter->prev != NULL);
+
+	pthread_mutex_lock(&dlist->write_lock);
+	ret_iter = RcuErase(dlist, iter);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (ret_iter);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) amortized **** */
+void *RcuDlistPopFront(rcu_dlist_t *dlist)
+{
+	void *ret_data = NULL;
+
+	assert (dlist != NULL);
+
+	pthread_mutex_lock(&dlist->write_lock);
+	assert ((dlist->head).next != &(dlist->tail));
+	ret_data = (dlist->head).next->data;
+	RcuErase(dlist, (dlist->head).next);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (ret_data);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) amortized **** */
+void *RcuDlistPopBack(rcu_dlist_t *dlist)
+{
+	void *ret_data = NULL;
+
+	assert (dlist != NULL);
+
+	pthread_mutex_lock(&dlist->write_lock);
+	assert ((dlist->tail).prev != &(dlist->head));
+	ret_data = (dlist->tail).prev->data;
+	RcuErase(dlist, (dlist->tail).prev);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (ret_data);
+}
+
+/* ************************** */
+/* **** Complexity: O(1) **** */
+rcu_dlist_iter_t RcuDlistSplice(rcu_dlist_t *dlist, rcu_dlist_iter_t where,
+								rcu_dlist_iter_t from, rcu_dlist_iter_t to)
+{
+	rcu_dlist_node_t *before_from = NULL;
+	rcu_dlist_node_t *last = NULL;
+	rcu_dlist_node_t *before_where = NULL;
+
+	assert (dlist != NULL);
+	assert (where != NULL);
+	assert (from != NULL);
+	assert (to != NULL);
+	assert (!RcuDlistIsSameIter(from, to));
+
+	pthread_mutex_lock(&dlist->write_lock);
+
+	before_from = from->prev;
+	last = to->prev;
+	before_where = where->prev;
+
+	if (where != to)
+	{
+		/* a. detach [from, last]: readers inside it leave through last->next */
+		/* b. point last to 'where': readers inside may revisit nodes, never loop */
+		/* c. link the range in front of 'where' */
+		/* d. fix prev fields, which readers don't use */
+		RcuPublish(&before_from->next, to);
+		RcuPublish(&last->next, where);
+		RcuPublish(&before_where->next, from);
+
+		to->prev = before_from;
+		from->prev = before_where;
+		where->prev = last;
+	}
+
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return (last);
+}
+
+/* ************************** */
+/* **** Complexity: O(retired) **** */
+void RcuDlistSynchronize(rcu_dlist_t *dlist)
+{
+	size_t target = 0;
+	size_t min_epoch = 0;
+
+	assert (dlist != NULL);
+
+	/* every node retired so far has an epoch smaller than 'target' */
+	target = __atomic_load_n(&dlist->epoch, __ATOMIC_SEQ_CST);
+
+	/* wait without write_lock, readers may call writer functions */
+	for (min_epoch = RcuMinReaderEpoch(dlist);
+		 min_epoch != 0 && min_epoch < target;
+		 min_epoch = RcuMinReaderEpoch(dlist))
+	{
+		sched_yield();
+	}
+
+	pthread_mutex_lock(&dlist->write_lock);
+	RcuReclaim(dlist);
+	pthread_mutex_unlock(&dlist->write_lock);
+
+	return;
+}
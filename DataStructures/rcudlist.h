@@ -0,0 +1,115 @@
+#ifndef RCUDLIST_H_
+#define RCUDLIST_H_
+
+#include <stddef.h>
+
+#include "allocator.h"
+
+/* Read-mostly doubly linked list.
+	Readers traverse without locks between RcuDlistReadLock and RcuDlistReadUnlock,
+	forward only (RcuDlistNext). Writers are serialized by an internal mutex and
+	publish every change with release stores, so a reader always sees a linked
+	chain from Begin to End. Erased nodes are freed only after every reader that
+	could still hold them has left its read section (epoch based grace period). */
+
+typedef struct rcu_dlist_st rcu_dlist_t;
+
+typedef struct rcu_dlist_node_st *rcu_dlist_iter_t;
+
+typedef struct rcu_dlist_reader_st rcu_dlist_reader_t;
+
+/* maximum number of registered readers per list */
+#define RCU_DLIST_MAX_READERS (64)
+
+/* Returns NULL on failure. Note: must be released by using RcuDlistDestroy */
+rcu_dlist_t *RcuDlistCreate(void);
+
+/* Same as RcuDlistCreate, the dlist and its nodes are allocated through 'allocator'
+	(NULL for the default malloc/free). 'allocator' must be thread safe. */
+rcu_dlist_t *RcuDlistCreateWithAllocator(const allocator_t *allocator);
+
+/* Destroy the list, all readers must be unregistered */
+void RcuDlistDestroy(rcu_dlist_t *dlist);
+
+/* ************************** Readers ************************** */
+
+/* Returns a reader slot for the calling thread, NULL if all slots are taken */
+rcu_dlist_reader_t *RcuDlistReaderRegister(rcu_dlist_t *dlist);
+
+void RcuDlistReaderUnregister(rcu_dlist_reader_t *reader);
+
+/* Iterators (and data) obtained inside a read section may not be used after it ends.
+	Read sections must not be nested. Writer functions may be called inside a
+	read section, except RcuDlistSynchronize. */
+void RcuDlistReadLock(rcu_dlist_reader_t *reader);
+
+void RcuDlistReadUnlock(rcu_dlist_reader_t *reader);
+
+rcu_dlist_iter_t RcuDlistBegin(const rcu_dlist_t *dlist);
+
+rcu_dlist_iter_t RcuDlistEnd(const rcu_dlist_t *dlist);
+
+int RcuDlistIsSameIter(rcu_dlist_iter_t iter_1, rcu_dlist_iter_t iter_2);
+
+rcu_dlist_iter_t RcuDlistNext(rcu_dlist_iter_t iter);
+
+void *RcuDlistGetData(rcu_dlist_iter_t where);
+
+/* returns the number of elements in the dlist */
+size_t RcuDlistSize(const rcu_dlist_t *dlist);
+
+int RcuDlistIsEmpty(const rcu_dlist_t *dlist);
+
+/* returns 'to' if no match was found */
+rcu_dlist_iter_t RcuDlistFind(rcu_dlist_iter_t from,
+							rcu_dlist_iter_t to,
+							int (*is_match)
+								(const void *node_data,
+								const void *data,
+								void *param),
+							const void *data,
+							void *param);
+
+/* send the data from each node to func, along with param. stops in case func fails (return != 0). returns the last call from the user function */
+int RcuDlistForEach(rcu_dlist_iter_t from, rcu_dlist_iter_t to,
+					int (*func)
+					(void *node_data,
+					void *param),
+					void *param);
+
+/* ************************** Writers ************************** */
+/* 'where', 'from' and 'to' must be live nodes of 'dlist' (not erased),
+	usually found inside the caller's read section */
+
+/* insert before 'where', return an iterator to the new data inserted or END upon failure */
+rcu_dlist_iter_t RcuDlistInsert(rcu_dlist_t *dlist, rcu_dlist_iter_t where, void *data);
+
+/* return an iterator to the new data inserted or END upon failure */
+rcu_dlist_iter_t RcuDlistInsertAfter(rcu_dlist_t *dlist, rcu_dlist_iter_t where, void *data);
+
+/* return END upon failure */
+rcu_dlist_iter_t RcuDlistPushBack(rcu_dlist_t *dlist, void *data);
+
+/* return END upon failure */
+rcu_dlist_iter_t RcuDlistPushFront(rcu_dlist_t *dlist, void *data);
+
+/* Unlink iter and retire it, returns iter to the next node.
+	Readers standing on the erased node can still move on from it. */
+rcu_dlist_iter_t RcuDlistErase(rcu_dlist_t *dlist, rcu_dlist_iter_t iter);
+
+/* returns the popped data, the list must not be empty */
+void *RcuDlistPopFront(rcu_dlist_t *dlist);
+
+/* returns the popped data, the list must not be empty */
+void *RcuDlistPopBack(rcu_dlist_t *dlist);
+
+/* Move [from, to) before 'where' inside dlist, returns iter to the last spliced element.
+	A reader running concurrently may see the moved elements twice or skip them,
+	but always reaches END. */
+rcu_dlist_iter_t RcuDlistSplice(rcu_dlist_t *dlist, rcu_dlist_iter_t where,
+								rcu_dlist_iter_t from, rcu_dlist_iter_t to);
+
+/* Wait for a grace period and free every erased node */
+void RcuDlistSynchronize(rcu_dlist_t *dlist);
+
+#endif /*RCUDLIST_H_*/
@@ -0,0 +1,456 @@
+/* Work-stealing scheduler.
+	A worker looks for work in this order:
+	1. bottom of its own deque (most recently spawned, cache-hot)
+	2. the shared injection queue (tasks spawned from non-worker threads)
+	3. top of a random victim's deque (oldest task, usually the largest piece of work)
+	An idle worker (or joiner) yields for up to MAX_IDLE_ROUNDS failed searches, then
+	sleeps on a condition variable until 'events' changes: every spawn, every join
+	counter reaching 0 and 'pending' reaching 0 bump it. Reading 'events' before a
+	search and sleeping only if it didn't change means no wakeup is lost. */
+
+#include <stdlib.h> /* malloc, free */
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>	/* sched_yield */
+
+#include "wsdeque.h"
+#include "queue.h"
+#include "scheduler.h"
+
+#define DEQUE_INIT_CAPACITY (256)
+#define MAX_IDLE_ROUNDS (64)
+
+typedef struct sched_task_st sched_task_t;
+typedef struct sched_worker_st sched_worker_t;
+
+struct sched_task_st
+{
+	void (*func)(void *param);
+	void *param;
+	size_t *join;
+};
+
+struct sched_worker_st
+{
+	scheduler_t *sched;
+	ws_deque_t *deque;
+	pthread_t thread;
+	unsigned long seed;		/* victim selection */
+};
+
+struct scheduler_st
+{
+	sched_worker_t *workers;
+	size_t num_workers;
+
+	queue_t *inject;			/* tasks spawned outside the workers */
+	pthread_mutex_t inject_lock;
+
+	size_t pending;				/* spawned and not yet finished tasks */
+	size_t events;				/* bumped whenever a sleeper may have something to do */
+	size_t sleepers;			/* threads waiting on 'wakeup' */
+	int shutdown;
+	pthread_mutex_t sleep_lock;
+	pthread_cond_t wakeup;
+};
+
+/* the worker running on this thread, NULL for non-worker threads */
+static __thread sched_worker_t *g_current_worker = NULL;
+
+/* ************************************************************************************ */
+
+static sched_worker_t *CurrentWorker(const scheduler_t *sched)
+{
+	if (g_current_worker != NULL && g_current_worker->sched == sched)
+	{
+		return (g_current_worker);
+	}
+
+	return (NULL);
+}
+
+static unsigned long NextRandom(unsigned long *seed)
+{
+	/* xorshift */
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+
+	return (*seed);
+}
+
+static sched_task_t *StealTask(scheduler_t *sched, sched_worker_t *self, unsigned long *seed)
+{
+	sched_task_t *task = NULL;
+	size_t start = 0;
+	size_t i = 0;
+
+	start = (size_t)(NextRandom(seed) % sched->num_workers);
+
+	for (i = 0; i < sched->num_workers && NULL == task; ++i)
+	{
+		sched_worker_t *victim = &sched->workers[(start + i) % sched->num_workers];
+
+		if (victim != self)
+		{
+			task = (sched_task_t *)WsDequeSteal(victim->deque);
+		}
+	}
+
+	return (task);
+}
+
+/* Returns a task to run or NULL if none was found */
+static sched_task_t *FindTask(scheduler_t *sched, sched_worker_t *self, unsigned long *seed)
+{
+	sched_task_t *task = NULL;
+
+	if (self != NULL)
+	{
+		task = (sched_task_t *)WsDequePop(self->deque);
+		if (task != NULL)
+		{
+			return (task);
+		}
+	}
+
+	pthread_mutex_lock(&sched->inject_lock);
+	task = (sched_task_t *)QueueDequeue(sched->inject);
+	pthread_mutex_unlock(&sched->inject_lock);
+	if (task != NULL)
+	{
+		return (task);
+	}
+
+	return (StealTask(sched, self, seed));
+}
+
+/* Bump 'events' and wake one sleeper (or all of them) */
+static void Notify(scheduler_t *sched, int wake_all)
+{
+	__atomic_add_fetch(&sched->events, 1, __ATOMIC_SEQ_CST);
+
+	/* paired with the sleepers/events check in WaitForEvent */
+	if (__atomic_load_n(&sched->sleepers, __ATOMIC_SEQ_CST) > 0)
+	{
+		pthread_mutex_lock(&sched->sleep_lock);
+		if (wake_all)
+		{
+			pthread_cond_broadcast(&sched->wakeup);
+		}
+		else
+		{
+			pthread_cond_signal(&sched->wakeup);
+		}
+		pthread_mutex_unlock(&sched->sleep_lock);
+	}
+}
+
+static void RunTask(scheduler_t *sched, sched_task_t *task)
+{
+	size_t *join = task->join;
+
+	task->func(task->param);
+	free(task);
+
+	if (join != NULL && 0 == __atomic_sub_fetch(join, 1, __ATOMIC_SEQ_CST))
+	{
+		Notify(sched, 1);
+	}
+
+	if (0 == __atomic_sub_fetch(&sched->pending, 1, __ATOMIC_SEQ_CST))
+	{
+		Notify(sched, 1);
+	}
+}
+
+/* Sleep until 'events' moves past 'seen'. Returns 1 if the worker should exit */
+static int WaitForEvent(scheduler_t *sched, size_t seen)
+{
+	int stop = 0;
+
+	pthread_mutex_lock(&sched->sleep_lock);
+
+	__atomic_add_fetch(&sched->sleepers, 1, __ATOMIC_SEQ_CST);
+
+	while (__atomic_load_n(&sched->events, __ATOMIC_SEQ_CST) == seen &&
+		   !(sched->shutdown && 0 == __atomic_load_n(&sched->pending, __ATOMIC_SEQ_CST)))
+	{
+		pthread_cond_wait(&sched->wakeup, &sched->sleep_lock);
+	}
+
+	__atomic_sub_fetch(&sched->sleepers, 1, __ATOMIC_SEQ_CST);
+
+	stop = (sched->shutdown && 0 == __atomic_load_n(&sched->pending, __ATOMIC_SEQ_CST));
+
+	pthread_mutex_unlock(&sched->sleep_lock);
+
+	return (stop);
+}
+
+static void *WorkerMain(void *param)
+{
+	sched_worker_t *self = (sched_worker_t *)param;
+	scheduler_t *sched = self->sched;
+	sched_task_t *task = NULL;
+	size_t idle_rounds = 0;
+	size_t seen = 0;
+
+	g_current_worker = self;
+
+	for (;;)
+	{
+		seen = __atomic_load_n(&sched->events, __ATOMIC_SEQ_CST);
+
+		task = FindTask(sched, self, &self->seed);
+		if (task != NULL)
+		{
+			RunTask(sched, task);
+			idle_rounds = 0;
+		}
+		else if (0 != __atomic_load_n(&sched->pending, __ATOMIC_SEQ_CST) &&
+				 ++idle_rounds < MAX_IDLE_ROUNDS)
+		{
+			/* tasks are running elsewhere and may spawn more soon */
+			sched_yield();
+		}
+		else
+		{
+			idle_rounds = 0;
+			if (WaitForEvent(sched, seen))
+			{
+				break;
+			}
+		}
+	}
+
+	g_current_worker = NULL;
+
+	return (NULL);
+}
+
+/* Stop and join the first 'num_started' workers, free all deques */
+static void StopWorkers(scheduler_t *sched, size_t num_started)
+{
+	size_t i = 0;
+
+	pthread_mutex_lock(&sched->sleep_lock);
+	sched->shutdown = 1;
+	pthread_cond_broadcast(&sched->wakeup);
+	pthread_mutex_unlock(&sched->sleep_lock);
+
+	for (i = 0; i < num_started; ++i)
+	{
+		pthread_join(sched->workers[i].thread, NULL);
+	}
+
+	for (i = 0; i < sched->num_workers; ++i)
+	{
+		if (sched->workers[i].deque != NULL)
+		{
+			WsDequeDestroy(sched->workers[i].deque);
+		}
+	}
+}
+
+/* ************************************************************************************ */
+
+scheduler_t *SchedulerCreate(size_t num_workers)
+{
+	scheduler_t *sched = NULL;
+	size_t i = 0;
+	size_t num_started = 0;
+
+	assert(num_workers > 0);
+
+	sched = (scheduler_t *)malloc(sizeof(scheduler_t));
+	if (NULL == sched)
+	{
+		return (NULL);
+	}
+
+	sched->workers = (sched_worker_t *)calloc(num_workers, sizeof(sched_worker_t));
+	sched->inject = QueueCreate();
+	if (NULL == sched->workers || NULL == sched->inject)
+	{
+		free(sched->workers);
+		if (sched->inject != NULL)
+		{
+			QueueDestroy(sched->inject);
+		}
+		free(sched);
+		return (NULL);
+	}
+
+	sched->num_workers = num_workers;
+	sched->pending = 0;
+	sched->events = 0;
+	sched->sleepers = 0;
+	sched->shutdown = 0;
+	pthread_mutex_init(&sched->inject_lock, NULL);
+	pthread_mutex_init(&sched->sleep_lock, NULL);
+	pthread_cond_init(&sched->wakeup, NULL);
+
+	for (i = 0; i < num_workers; ++i)
+	{
+		sched->workers[i].sched = sched;
+		sched->workers[i].seed = 2463534242UL + i * 7919;
+		sched->workers[i].deque = WsDequeCreate(DEQUE_INIT_CAPACITY);
+		if (NULL == sched->workers[i].deque)
+		{
+			break;
+		}
+	}
+
+	/* start threads only when all deques exist */
+	for (num_started = 0; i == num_workers && num_started < num_workers; ++num_started)
+	{
+		if (0 != pthread_create(&sched->workers[num_started].thread, NULL,
+								WorkerMain, &sched->workers[num_started]))
+		{
+			break;
+		}
+	}
+
+	if (num_started < num_workers)
+	{
+		StopWorkers(sched, num_started);
+		pthread_cond_destroy(&sched->wakeup);
+		pthread_mutex_destroy(&sched->sleep_lock);
+		pthread_mutex_destroy(&sched->inject_lock);
+		QueueDestroy(sched->inject);
+		free(sched->workers);
+		free(sched);
+		return (NULL);
+	}
+
+	return (sched);
+}
+
+/* ************************************************************************************ */
+
+void SchedulerDestroy(scheduler_t *sched)
+{
+	assert(sched != NULL);
+	assert(NULL == CurrentWorker(sched));
+
+	/* workers exit only once 'pending' dropped to 0 */
+	StopWorkers(sched, sched->num_workers);
+
+	pthread_cond_destroy(&sched->wakeup);
+	pthread_mutex_destroy(&sched->sleep_lock);
+	pthread_mutex_destroy(&sched->inject_lock);
+	QueueDestroy(sched->inject);
+	free(sched->workers);
+	free(sched);
+
+	return;
+}
+
+/* ************************************************************************************ */
+
+int SchedulerSpawn(scheduler_t *sched, void (*task)(void *param), void *param, size_t *join)
+{
+	sched_task_t *new_task = NULL;
+	sched_worker_t *self = NULL;
+	int status = 0;
+
+	assert(sched != NULL);
+	assert(task != NULL);
+
+	new_task = (sched_task_t *)malloc(sizeof(sched_task_t));
+	if (NULL == new_task)
+	{
+		return (1);
+	}
+
+	new_task->func = task;
+	new_task->param = param;
+	new_task->join = join;
+
+	if (join != NULL)
+	{
+		__atomic_add_fetch(join, 1, __ATOMIC_RELAXED);
+	}
+	__atomic_add_fetch(&sched->pending, 1, __ATOMIC_SEQ_CST);
+
+	self = CurrentWorker(sched);
+	if (self != NULL)
+	{
+		status = WsDequePush(self->deque, new_task);
+	}
+	else
+	{
+		pthread_mutex_lock(&sched->inject_lock);
+		status = QueueEnqueue(sched->inject, new_task);
+		pthread_mutex_unlock(&sched->inject_lock);
+	}
+
+	if (status != 0)
+	{
+		if (join != NULL)
+		{
+			__atomic_sub_fetch(join, 1, __ATOMIC_RELAXED);
+		}
+		__atomic_sub_fetch(&sched->pending, 1, __ATOMIC_SEQ_CST);
+		free(new_task);
+		return (1);
+	}
+
+	Notify(sched, 0);
+
+	return (0);
+}
+
+/* ************************************************************************************ */
+
+void SchedulerJoin(scheduler_t *sched, size_t *join)
+{
+	sched_worker_t *self = NULL;
+	sched_task_t *task = NULL;
+	unsigned long seed = (unsigned long)join | 1;
+	size_t idle_rounds = 0;
+	size_t seen = 0;
+
+	assert(sched != NULL);
+	assert(join != NULL);
+
+	self = CurrentWorker(sched);
+
+	for (;;)
+	{
+		/* read 'events' first: the task ending the join bumps it after the counter drops */
+		seen = __atomic_load_n(&sched->events, __ATOMIC_SEQ_CST);
+		if (0 == __atomic_load_n(join, __ATOMIC_SEQ_CST))
+		{
+			break;
+		}
+
+		task = FindTask(sched, self, (self != NULL) ? &self->seed : &seed);
+		if (task != NULL)
+		{
+			RunTask(sched, task);
+			idle_rounds = 0;
+		}
+		else if (++idle_rounds < MAX_IDLE_ROUNDS)
+		{
+			sched_yield();
+		}
+		else
+		{
+			idle_rounds = 0;
+			WaitForEvent(sched, seen);
+		}
+	}
+
+	return;
+}
+
+/* ************************************************************************************ */
+
+size_t SchedulerNumWorkers(const scheduler_t *sched)
+{
+	assert(sched != NULL);
+
+	return (sched->num_workers);
+}
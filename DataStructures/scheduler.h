@@ -0,0 +1,35 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stddef.h> /* size_t */
+
+/* Fork/join task scheduler.
+	Each worker thread owns a ws_deque_t: tasks spawned by a worker go to the
+	bottom of its own deque, idle workers steal from the top of other deques.
+	Tasks spawned from outside the scheduler go through a shared queue_t.
+	Task records use malloc/free (not an allocator_t), they are allocated and
+	freed on different worker threads. */
+
+typedef struct scheduler_st scheduler_t;
+
+/* Returns pointer to a new scheduler running 'num_workers' threads, NULL on failure.
+	Note: must be released by using SchedulerDestroy. */
+scheduler_t *SchedulerCreate(size_t num_workers);
+
+/* Runs all pending tasks to completion, then stops the workers and frees the scheduler */
+void SchedulerDestroy(scheduler_t *sched);
+
+/* Schedule task(param).
+	If 'join' is not NULL, *join is incremented now and decremented when the task ends,
+	so several tasks can share one counter and be waited for with SchedulerJoin.
+	Returns 0 for success and 1 for failure */
+int SchedulerSpawn(scheduler_t *sched, void (*task)(void *param), void *param, size_t *join);
+
+/* Wait until *join drops to 0. The calling thread runs other tasks meanwhile,
+	so it is safe (and intended) to call it from inside a task. */
+void SchedulerJoin(scheduler_t *sched, size_t *join);
+
+/* returns number of worker threads */
+size_t SchedulerNumWorkers(const scheduler_t *sched);
+
+#endif   /*   SCHEDULER_H_    */
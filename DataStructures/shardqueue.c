@@ -0,0 +1,235 @@
+/* Each shard is a queue_t and its mutex, padded to whole cache lines.
+	The queue is embedded in the shard (not a separate heap object), and the
+	shards array is over-allocated and aligned to a cache line, so neither the
+	lock nor the queue state of one shard shares a line with another shard.
+	The queue comes first: the fields it touches on every operation fill the
+	first line of the shard. Shards are SHARD_STRIDE bytes apart (their size
+	rounded up to whole lines), see ShardAt.
+	A consumer holds its own shard's lock while it steals, and only 'trylocks'
+	victims, so two consumers stealing from each other can't deadlock. */
+
+#include <assert.h>
+#include <stdint.h>		/* uintptr_t */
+#include <pthread.h>
+
+#include "queue.h"
+#include "queue_inline.h"	/* queue layout, to embed it in the shard */
+#include "shardqueue.h"
+
+#define CACHE_LINE (64)
+
+typedef struct queue_shard_st queue_shard_t;
+
+struct queue_shard_st
+{
+	queue_t queue;
+	pthread_mutex_t lock;
+};
+
+#define SHARD_STRIDE ((sizeof(queue_shard_t) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE)
+
+struct shard_queue_st
+{
+	size_t num_shards;
+	allocator_t allocator;
+	char *shards;			/* cache line aligned, inside shards_mem */
+	void *shards_mem;		/* as allocated */
+};
+
+/* ************************************************************************************ */
+
+/* Round ptr up to a multiple of CACHE_LINE */
+static void *AlignToCacheLine(void *ptr)
+{
+	return ((void *)(((uintptr_t)ptr + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1)));
+}
+
+static queue_shard_t *ShardAt(const shard_queue_t *squeue, size_t index)
+{
+	return ((queue_shard_t *)(squeue->shards + index * SHARD_STRIDE));
+}
+
+/* Move the content of some other shard into 'self', called with self->lock held.
+	QueueAppend may need nodes for the victim's inline elements: if that fails
+	the victim is left as it was and the next shard is tried.
+	Returns 1 if a batch was moved */
+static int StealBatch(shard_queue_t *squeue, size_t self)
+{
+	queue_shard_t *victim = NULL;
+	size_t i = 0;
+	int stolen = 0;
+
+	for (i = 1; i < squeue->num_shards && !stolen; ++i)
+	{
+		victim = ShardAt(squeue, (self + i) % squeue->num_shards);
+
+		if (0 == pthread_mutex_trylock(&victim->lock))
+		{
+			if (!QueueIsEmpty(&victim->queue))
+			{
+				stolen = (0 == QueueAppend(&ShardAt(squeue, self)->queue, &victim->queue));
+			}
+			pthread_mutex_unlock(&victim->lock);
+		}
+	}
+
+	return (stolen);
+}
+
+/* ************************************************************************************ */
+
+shard_queue_t *ShardQueueCreate(size_t num_shards)
+{
+	return (ShardQueueCreateWithAllocator(num_shards, NULL));
+}
+
+/* ************************************************************************************ */
+
+shard_queue_t *ShardQueueCreateWithAllocator(size_t num_shards, const allocator_t *allocator)
+{
+	shard_queue_t *squeue = NULL;
+	size_t i = 0;
+
+	assert(num_shards > 0);
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	squeue = (shard_queue_t *)AllocatorAlloc(allocator, sizeof(shard_queue_t));
+	if (NULL == squeue)
+	{
+		return (NULL);
+	}
+
+	/* allocators only promise malloc's alignment, leave room to align the array */
+	squeue->shards_mem = AllocatorAlloc(allocator, num_shards * SHARD_STRIDE + CACHE_LINE - 1);
+	if (NULL == squeue->shards_mem)
+	{
+		AllocatorFree(allocator, squeue);
+		return (NULL);
+	}
+
+	squeue->shards = (char *)AlignToCacheLine(squeue->shards_mem);
+
+	squeue->num_shards = num_shards;
+	squeue->allocator = *allocator;
+
+	for (i = 0; i < num_shards; ++i)
+	{
+		QueueInit(&ShardAt(squeue, i)->queue, allocator);
+		pthread_mutex_init(&ShardAt(squeue, i)->lock, NULL);
+	}
+
+	return (squeue);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(n) ****** */
+void ShardQueueDestroy(shard_queue_t *squeue)
+{
+	size_t i = 0;
+
+	assert(squeue != NULL);
+
+	for (i = 0; i < squeue->num_shards; ++i)
+	{
+		pthread_mutex_destroy(&ShardAt(squeue, i)->lock);
+		QueueDeinit(&ShardAt(squeue, i)->queue);
+	}
+
+	AllocatorFree(&squeue->allocator, squeue->shards_mem);
+	AllocatorFree(&squeue->allocator, squeue);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t ShardQueueNumShards(const shard_queue_t *squeue)
+{
+	assert(squeue != NULL);
+
+	return (squeue->num_shards);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+int ShardQueueEnqueue(shard_queue_t *squeue, size_t shard, void *data)
+{
+	queue_shard_t *local = NULL;
+	int status = 0;
+
+	assert(squeue != NULL);
+
+	local = ShardAt(squeue, shard % squeue->num_shards);
+
+	pthread_mutex_lock(&local->lock);
+	status = QueueEnqueue(&local->queue, data);
+	pthread_mutex_unlock(&local->lock);
+
+	return (status);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1), O(shards * QUEUE_INLINE_CAPACITY) when stealing ****** */
+void *ShardQueueDequeue(shard_queue_t *squeue, size_t shard)
+{
+	queue_shard_t *local = NULL;
+	void *ret_data = NULL;
+
+	assert(squeue != NULL);
+
+	shard %= squeue->num_shards;
+	local = ShardAt(squeue, shard);
+
+	pthread_mutex_lock(&local->lock);
+
+	if (!QueueIsEmpty(&local->queue) || StealBatch(squeue, shard))
+	{
+		ret_data = QueueDequeue(&local->queue);
+	}
+
+	pthread_mutex_unlock(&local->lock);
+
+	return (ret_data);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(shards) ****** */
+size_t ShardQueueSize(shard_queue_t *squeue)
+{
+	size_t size = 0;
+	size_t i = 0;
+
+	assert(squeue != NULL);
+
+	for (i = 0; i < squeue->num_shards; ++i)
+	{
+		pthread_mutex_lock(&ShardAt(squeue, i)->lock);
+		size += QueueSize(&ShardAt(squeue, i)->queue);
+		pthread_mutex_unlock(&ShardAt(squeue, i)->lock);
+	}
+
+	return (size);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(shards) ****** */
+int ShardQueueIsEmpty(shard_queue_t *squeue)
+{
+	int is_empty = 1;
+	size_t i = 0;
+
+	assert(squeue != NULL);
+
+	for (i = 0; i < squeue->num_shards && is_empty; ++i)
+	{
+		pthread_mutex_lock(&ShardAt(squeue, i)->lock);
+		is_empty = QueueIsEmpty(&ShardAt(squeue, i)->queue);
+		pthread_mutex_unlock(&ShardAt(squeue, i)->lock);
+	}
+
+	return (is_empty);
+}
@@ -0,0 +1,44 @@
+#ifndef SHARDQUEUE_H_
+#define SHARDQUEUE_H_
+
+#include <stddef.h> /* size_t */
+
+#include "allocator.h"
+
+/* Sharded multi-queue: a set of locked queue_t shards, usually one per thread.
+	Producers enqueue to their own shard, consumers dequeue from their own shard
+	and, when it is empty, move the whole content of another shard into it
+	with QueueAppend (O(QUEUE_INLINE_CAPACITY), may allocate and fail: the
+	consumer then tries the next shard).
+	Order is FIFO within a shard only, there is no global order between shards. */
+
+typedef struct shard_queue_st shard_queue_t;
+
+/* Returns pointer to a new queue with 'num_shards' shards, NULL on failure.
+	Note: must be released by using ShardQueueDestroy. */
+shard_queue_t *ShardQueueCreate(size_t num_shards);
+
+/* Same as ShardQueueCreate, allocating through 'allocator' (NULL for the default malloc/free).
+	'allocator' must be thread safe. */
+shard_queue_t *ShardQueueCreateWithAllocator(size_t num_shards, const allocator_t *allocator);
+
+void ShardQueueDestroy(shard_queue_t *squeue);
+
+/* returns number of shards */
+size_t ShardQueueNumShards(const shard_queue_t *squeue);
+
+/* Push data to the end of 'shard' (taken modulo the number of shards).
+	Returns 0 for success and 1 for failure */
+int ShardQueueEnqueue(shard_queue_t *squeue, size_t shard, void *data);
+
+/* Remove data from the head of 'shard', or steal a batch from another shard if it is empty.
+	Returns NULL if no element was found. Shards locked by other threads are skipped,
+	so NULL doesn't guarantee the whole queue is empty. */
+void *ShardQueueDequeue(shard_queue_t *squeue, size_t shard);
+
+/* Total number of elements, a snapshot only while other threads are active */
+size_t ShardQueueSize(shard_queue_t *squeue);
+
+int ShardQueueIsEmpty(shard_queue_t *squeue);
+
+#endif   /*   SHARDQUEUE_H_    */
@@ -0,0 +1,449 @@
+/* Bounded MPMC ring (Vyukov) laid out in one shared memory segment:
+
+	| header | slot 0 | slot 1 | ... | slot capacity-1 |
+
+	Every slot has a sequence number that tells whose turn it is:
+	sequence == pos             free, producer of position 'pos' may write it
+	sequence == pos + 1         holds the message of 'pos', its consumer may read it
+	sequence == pos + capacity  read, free for the producer of the next round
+	Producers and consumers claim positions with a CAS on enqueue_pos / dequeue_pos,
+	and hand the slot over with a release store to its sequence. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>		/* malloc, free */
+#include <stddef.h>		/* offsetof */
+#include <string.h>		/* memcpy */
+#include <assert.h>
+#include <fcntl.h>		/* O_* */
+#include <sys/mman.h>	/* shm_open, mmap */
+#include <sys/stat.h>	/* fstat */
+#include <unistd.h>		/* ftruncate, close */
+
+#include "shmqueue.h"
+
+#define CACHE_LINE (64)
+#define SHM_QUEUE_MAGIC ((size_t)0x53484D5155455545UL)	/* "SHMQUEUE" */
+
+typedef struct shm_header_st shm_header_t;
+typedef struct shm_slot_st shm_slot_t;
+
+struct shm_header_st
+{
+	size_t magic;			/* written last by the creator */
+	size_t capacity;		/* power of 2 */
+	size_t msg_size;
+	size_t slot_size;		/* offset between slots */
+	char pad1[CACHE_LINE - 4 * sizeof(size_t)];
+
+	size_t enqueue_pos;
+	char pad2[CACHE_LINE - sizeof(size_t)];
+
+	size_t dequeue_pos;
+	char pad3[CACHE_LINE - sizeof(size_t)];
+};
+
+struct shm_slot_st
+{
+	size_t sequence;
+	size_t length;
+	char payload[1];
+};
+
+/* The geometry is copied here once it is validated: any process may write the
+	shared header, so nothing that bounds an access is read from it afterwards */
+struct shm_queue_st
+{
+	shm_header_t *header;	/* start of the mapping */
+	char *slots;			/* first slot, right after the header */
+	size_t map_size;
+	size_t mask;			/* capacity - 1 */
+	size_t slot_size;
+	size_t msg_size;
+};
+
+/* ************************************************************************************ */
+
+static shm_slot_t *SlotOf(const shm_queue_t *queue, size_t pos)
+{
+	return ((shm_slot_t *)(queue->slots + (pos & queue->mask) * queue->slot_size));
+}
+
+/* Keep a private copy of the (validated) geometry of the segment */
+static void CopyGeometry(shm_queue_t *queue, size_t capacity, size_t slot_size, size_t msg_size)
+{
+	queue->slots = (char *)queue->header + sizeof(shm_header_t);
+	queue->mask = capacity - 1;
+	queue->slot_size = slot_size;
+	queue->msg_size = msg_size;
+}
+
+static size_t SegmentSize(size_t capacity, size_t slot_size)
+{
+	return (sizeof(shm_header_t) + capacity * slot_size);
+}
+
+/* Check the geometry an attaching process reads from a segment of 'map_size' bytes:
+	capacity must be a non-zero power of 2 and the slots must fit the mapping
+	(checked by division, so a corrupt header can't overflow the product) */
+static int IsValidHeader(const shm_header_t *header, size_t map_size)
+{
+	size_t capacity = header->capacity;
+	size_t slot_size = header->slot_size;
+
+	if (0 == capacity || 0 != (capacity & (capacity - 1)))
+	{
+		return (0);
+	}
+
+	if (slot_size < offsetof(shm_slot_t, payload) ||
+		slot_size - offsetof(shm_slot_t, payload) < header->msg_size)
+	{
+		return (0);
+	}
+
+	return (capacity <= (map_size - sizeof(shm_header_t)) / slot_size);
+}
+
+/* Map an open segment of 'map_size' bytes, returns NULL on failure */
+static shm_queue_t *MapSegment(int fd, size_t map_size)
+{
+	shm_queue_t *queue = NULL;
+	void *addr = NULL;
+
+	queue = (shm_queue_t *)malloc(sizeof(shm_queue_t));
+	if (NULL == queue)
+	{
+		return (NULL);
+	}
+
+	addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == addr)
+	{
+		free(queue);
+		return (NULL);
+	}
+
+	queue->header = (shm_header_t *)addr;
+	queue->map_size = map_size;
+
+	return (queue);
+}
+
+/* ************************************************************************************ */
+
+shm_queue_t *ShmQueueCreate(const char *name, size_t capacity, size_t msg_size)
+{
+	shm_queue_t *queue = NULL;
+	shm_header_t *header = NULL;
+	size_t slot_size = 0;
+	size_t size = 1;
+	size_t i = 0;
+	int fd = -1;
+
+	assert(name != NULL);
+	assert(capacity > 0);
+
+	/* round capacity up to a power of 2, and slots to whole cache lines */
+	while (size < capacity)
+	{
+		size *= 2;
+	}
+	slot_size = (offsetof(shm_slot_t, payload) + msg_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0)
+	{
+		return (NULL);
+	}
+
+	if (0 != ftruncate(fd, (off_t)SegmentSize(size, slot_size)) ||
+		NULL == (queue = MapSegment(fd, SegmentSize(size, slot_size))))
+	{
+		close(fd);
+		shm_unlink(name);
+		return (NULL);
+	}
+	close(fd);
+
+	CopyGeometry(queue, size, slot_size, msg_size);
+
+	header = queue->header;
+	header->capacity = size;
+	header->msg_size = msg_size;
+	header->slot_size = slot_size;
+	header->enqueue_pos = 0;
+	header->dequeue_pos = 0;
+
+	for (i = 0; i < size; ++i)
+	{
+		SlotOf(queue, i)->sequence = i;
+		SlotOf(queue, i)->length = 0;
+	}
+
+	/* publish the initialized segment to attaching processes */
+	__atomic_store_n(&header->magic, SHM_QUEUE_MAGIC, __ATOMIC_RELEASE);
+
+	return (queue);
+}
+
+/* ************************************************************************************ */
+
+shm_queue_t *ShmQueueAttach(const char *name)
+{
+	shm_queue_t *queue = NULL;
+	shm_header_t header;
+	struct stat st;
+	int fd = -1;
+
+	assert(name != NULL);
+
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+	{
+		return (NULL);
+	}
+
+	if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(shm_header_t) ||
+		NULL == (queue = MapSegment(fd, (size_t)st.st_size)))
+	{
+		close(fd);
+		return (NULL);
+	}
+	close(fd);
+
+	/* validate a snapshot of the header, another process may change it meanwhile */
+	if (__atomic_load_n(&queue->header->magic, __ATOMIC_ACQUIRE) != SHM_QUEUE_MAGIC)
+	{
+		ShmQueueDetach(queue);
+		return (NULL);
+	}
+
+	header = *queue->header;
+	if (!IsValidHeader(&header, queue->map_size))
+	{
+		ShmQueueDetach(queue);
+		return (NULL);
+	}
+
+	CopyGeometry(queue, header.capacity, header.slot_size, header.msg_size);
+
+	return (queue);
+}
+
+/* ************************************************************************************ */
+
+void ShmQueueDetach(shm_queue_t *queue)
+{
+	assert(queue != NULL);
+
+	munmap(queue->header, queue->map_size);
+	free(queue);
+
+	return;
+}
+
+/* ************************************************************************************ */
+
+int ShmQueueUnlink(const char *name)
+{
+	assert(name != NULL);
+
+	return (0 != shm_unlink(name));
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t ShmQueueMsgSize(const shm_queue_t *queue)
+{
+	assert(queue != NULL);
+
+	return (queue->msg_size);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t ShmQueueCapacity(const shm_queue_t *queue)
+{
+	assert(queue != NULL);
+
+	return (queue->mask + 1);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) (retries on contention) ****** */
+void *ShmQueueEnqueueBegin(shm_queue_t *queue, size_t *ticket)
+{
+	shm_header_t *header = NULL;
+	shm_slot_t *slot = NULL;
+	size_t pos = 0;
+	long diff = 0;
+
+	assert(queue != NULL);
+	assert(ticket != NULL);
+
+	header = queue->header;
+	pos = __atomic_load_n(&header->enqueue_pos, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		slot = SlotOf(queue, pos);
+		diff = (long)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+
+		if (0 == diff)
+		{
+			/* slot is free for 'pos', claim the position */
+			if (__atomic_compare_exchange_n(&header->enqueue_pos, &pos, pos + 1, 1,
+											__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			/* slot still holds the message of the previous round */
+			return (NULL);
+		}
+		else
+		{
+			pos = __atomic_load_n(&header->enqueue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	*ticket = pos;
+
+	return (slot->payload);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+int ShmQueueEnqueueCommit(shm_queue_t *queue, size_t ticket, size_t length)
+{
+	shm_slot_t *slot = NULL;
+	int status = 0;
+
+	assert(queue != NULL);
+
+	/* the slot is published anyway (empty), or the ring would stall on it */
+	if (length > queue->msg_size)
+	{
+		length = 0;
+		status = 1;
+	}
+
+	slot = SlotOf(queue, ticket);
+	slot->length = length;
+
+	__atomic_store_n(&slot->sequence, ticket + 1, __ATOMIC_RELEASE);
+
+	return (status);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) (retries on contention) ****** */
+const void *ShmQueueDequeueBegin(shm_queue_t *queue, size_t *ticket, size_t *length)
+{
+	shm_header_t *header = NULL;
+	shm_slot_t *slot = NULL;
+	size_t pos = 0;
+	long diff = 0;
+
+	assert(queue != NULL);
+	assert(ticket != NULL);
+	assert(length != NULL);
+
+	header = queue->header;
+	pos = __atomic_load_n(&header->dequeue_pos, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		slot = SlotOf(queue, pos);
+		diff = (long)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - (pos + 1));
+
+		if (0 == diff)
+		{
+			/* slot holds the message of 'pos', claim the position */
+			if (__atomic_compare_exchange_n(&header->dequeue_pos, &pos, pos + 1, 1,
+											__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			/* not written yet */
+			return (NULL);
+		}
+		else
+		{
+			pos = __atomic_load_n(&header->dequeue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	*ticket = pos;
+	*length = slot->length;
+
+	/* written by another process, never trust it past the slot */
+	if (*length > queue->msg_size)
+	{
+		*length = queue->msg_size;
+	}
+
+	return (slot->payload);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void ShmQueueDequeueCommit(shm_queue_t *queue, size_t ticket)
+{
+	assert(queue != NULL);
+
+	__atomic_store_n(&SlotOf(queue, ticket)->sequence, ticket + queue->mask + 1, __ATOMIC_RELEASE);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(length) ****** */
+int ShmQueueEnqueue(shm_queue_t *queue, const void *msg, size_t length)
+{
+	void *payload = NULL;
+	size_t ticket = 0;
+
+	assert(queue != NULL);
+
+	if (length > queue->msg_size)
+	{
+		return (1);
+	}
+
+	payload = ShmQueueEnqueueBegin(queue, &ticket);
+	if (NULL == payload)
+	{
+		return (1);
+	}
+
+	memcpy(payload, msg, length);
+
+	return (ShmQueueEnqueueCommit(queue, ticket, length));
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(length) ****** */
+int ShmQueueDequeue(shm_queue_t *queue, void *buf, size_t *length)
+{
+	const void *payload = NULL;
+	size_t ticket = 0;
+
+	assert(queue != NULL);
+	assert(length != NULL);
+
+	payload = ShmQueueDequeueBegin(queue, &ticket, length);
+	if (NULL == payload)
+	{
+		return (1);
+	}
+
+	memcpy(buf, payload, *length);
+	ShmQueueDequeueCommit(queue, ticket);
+
+	return (0);
+}
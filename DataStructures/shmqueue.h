@@ -0,0 +1,63 @@
+#ifndef SHMQUEUE_H_
+#define SHMQUEUE_H_
+
+#include <stddef.h> /* size_t */
+
+/* Inter-process queue in a POSIX shared memory segment.
+	A bounded lock-free multi-producer multi-consumer ring of fixed size slots.
+	The segment holds no pointers, only positions and slot indexes, so every
+	process may map it at a different address.
+	Zero copy: a producer writes its message directly into a slot between
+	ShmQueueEnqueueBegin and ShmQueueEnqueueCommit, and a consumer reads it in
+	place between ShmQueueDequeueBegin and ShmQueueDequeueCommit.
+	Note: a process that dies between Begin and Commit blocks that slot for good. */
+
+typedef struct shm_queue_st shm_queue_t;
+
+/* Create the segment 'name' (e.g. "/my_queue", must not exist) with 'capacity' slots
+	(rounded up to a power of 2) of up to 'msg_size' bytes, and attach to it.
+	Returns NULL on failure.
+	Note: must be released by using ShmQueueDetach, the segment itself by ShmQueueUnlink. */
+shm_queue_t *ShmQueueCreate(const char *name, size_t capacity, size_t msg_size);
+
+/* Attach to an existing segment. Returns NULL on failure, or if its creator
+	didn't finish initializing it yet (try again). */
+shm_queue_t *ShmQueueAttach(const char *name);
+
+/* Unmap the segment from this process */
+void ShmQueueDetach(shm_queue_t *queue);
+
+/* Remove the segment name, it is freed once every process detached.
+	Returns 0 for success and 1 for failure */
+int ShmQueueUnlink(const char *name);
+
+/* returns maximal message size */
+size_t ShmQueueMsgSize(const shm_queue_t *queue);
+
+/* returns number of slots */
+size_t ShmQueueCapacity(const shm_queue_t *queue);
+
+/* Reserve a slot. Returns pointer to ShmQueueMsgSize bytes to write the message to,
+	and its ticket in *ticket, or NULL if the queue is full */
+void *ShmQueueEnqueueBegin(shm_queue_t *queue, size_t *ticket);
+
+/* Publish the message of 'ticket', 'length' bytes long.
+	Returns 0 for success and 1 if length > msg size (an empty message is published instead) */
+int ShmQueueEnqueueCommit(shm_queue_t *queue, size_t ticket, size_t length);
+
+/* Take the oldest message. Returns pointer to it, its length in *length and its
+	ticket in *ticket, or NULL if the queue is empty.
+	A length larger than ShmQueueMsgSize (corrupt segment) is cut to ShmQueueMsgSize */
+const void *ShmQueueDequeueBegin(shm_queue_t *queue, size_t *ticket, size_t *length);
+
+/* Give the slot of 'ticket' back to producers, the message may not be used anymore */
+void ShmQueueDequeueCommit(shm_queue_t *queue, size_t ticket);
+
+/* Copy msg into the queue. Returns 0 for success and 1 for failure (full, or length > msg size) */
+int ShmQueueEnqueue(shm_queue_t *queue, const void *msg, size_t length);
+
+/* Copy the oldest message into buf (room for ShmQueueMsgSize bytes), its length to *length.
+	Returns 0 for success and 1 if the queue is empty */
+int ShmQueueDequeue(shm_queue_t *queue, void *buf, size_t *length);
+
+#endif   /*   SHMQUEUE_H_    */
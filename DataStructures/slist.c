@@ -1,14 +1,23 @@
-#include <stdlib.h>		/* malloc */
 #include <assert.h>
 
 #include "slist.h"
 
 
 slist_node_t *SListCreateAndInitNode(void *data, slist_node_t *next)
+{
+	return (SListCreateAndInitNodeWithAllocator(data, next, NULL));
+}
+
+slist_node_t *SListCreateAndInitNodeWithAllocator(void *data, slist_node_t *next, const allocator_t *allocator)
 {
 	slist_node_t *new_node = NULL;
 	
-	new_node = (slist_node_t *)malloc(sizeof(slist_node_t));
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+	
+	new_node = (slist_node_t *)AllocatorAlloc(allocator, sizeof(slist_node_t));
 	if (NULL == new_node)
 	{
 		return (NULL);
@@ -83,21 +92,46 @@ slist_node_t *SListRemoveAfter(slist_node_t *node)
 
 /*  **** Complexity: O(n) ****** */
 void SListFreeAll(slist_node_t *head)
+{
+	SListFreeAllWithAllocator(head, NULL);
+}
+
+/*  **** Complexity: O(n) ****** */
+void SListFreeAllWithAllocator(slist_node_t *head, const allocator_t *allocator)
 {
 	slist_node_t *temp_node = NULL;
 
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
 	while (head != NULL)
 	{
 		temp_node = head;
 		head = head->next;
 		
-		free(temp_node);
+		AllocatorFree(allocator, temp_node);
 		temp_node = NULL;
 	}	
 	
 	return;
 }
 
+/*  **** Complexity: O(1) ****** */
+slist_node_t *SListConcat(slist_node_t *tail1, slist_node_t *head2, slist_node_t *tail2)
+{
+	assert(tail1 != NULL);
+	assert(NULL == tail1->next);
+	assert(head2 != NULL);
+	assert(tail2 != NULL);
+	assert(NULL == tail2->next);
+
+	tail1->next = head2;
+
+	return (tail2);
+}
+
 /*  **** Complexity: O(n) ****** */
 size_t SListCount(const slist_node_t *head)
 {
@@ -131,35 +165,102 @@ slist_node_t *SListFind(slist_node_t *head, int (*is_match)(const void *node_dat
 }
 
 
-/*  **** Complexity: O(n) ****** */
-int SListHasLoop(const slist_node_t *head)
-/* loop on list from head with two pointers:*/
-/* every loop one pointer jump one node ahead and the other two nodes .*/
-/* until null (no loop) or until the faster pointer meets the slower one */
+/* Brent's algorithm, returns the loop length or 0 if there is no loop.
+	When there is no loop, also sets the number of nodes and the last node
+	(so callers that need them don't walk the list again) */
+static size_t SListBrentWalk(const slist_node_t *head, size_t *num_nodes, const slist_node_t **tail)
 {
-	const slist_node_t *fast_node = NULL;
-	const slist_node_t *slow_node = head;
-	
+	const slist_node_t *tortoise = head;
+	const slist_node_t *hare = NULL;
+	const slist_node_t *last = head;
+	size_t power = 1;
+	size_t length = 1;
+	size_t count = 1;
+
+	*num_nodes = 0;
+	*tail = NULL;
+
 	if (NULL == head)
 	{
 		return (0);
 	}
-	
-	fast_node = head->next;
-	
-	while (fast_node != NULL && fast_node->next != NULL)
+
+	hare = head->next;
+
+	while (hare != tortoise)
 	{
-		if (fast_node == slow_node || fast_node->next == slow_node)
+		if (NULL == hare)
 		{
-			return (1);
+			*num_nodes = count;
+			*tail = last;
+			return (0);
 		}
-		
-		fast_node = fast_node->next->next;
-		
-		slow_node = slow_node->next;
+
+		/* start a new, twice as long, round from the hare's position */
+		if (power == length)
+		{
+			tortoise = hare;
+			power *= 2;
+			length = 0;
+		}
+
+		last = hare;
+		hare = hare->next;
+		++length;
+		++count;
 	}
-	
-	return (0);
+
+	return (length);
+}
+
+/* Returns the first node of the loop, given the loop length */
+static const slist_node_t *SListLoopStartOf(const slist_node_t *head, size_t length)
+/* place one pointer 'loop length' nodes ahead of the other, */
+/* then walk both one node at a time: they meet at the loop start */
+{
+	const slist_node_t *behind = head;
+	const slist_node_t *ahead = head;
+
+	for (; length > 0; --length)
+	{
+		ahead = ahead->next;
+	}
+
+	while (ahead != behind)
+	{
+		ahead = ahead->next;
+		behind = behind->next;
+	}
+
+	return (behind);
+}
+
+/*  **** Complexity: O(n) ****** */
+int SListHasLoop(const slist_node_t *head)
+{
+	size_t num_nodes = 0;
+	const slist_node_t *tail = NULL;
+
+	return (SListBrentWalk(head, &num_nodes, &tail) != 0);
+}
+
+/*  **** Complexity: O(n) ****** */
+slist_node_t *SListFindLoopStart(const slist_node_t *head)
+{
+	size_t num_nodes = 0;
+	const slist_node_t *tail = NULL;
+	size_t length = SListBrentWalk(head, &num_nodes, &tail);
+
+	return ((0 == length) ? NULL : (slist_node_t *)SListLoopStartOf(head, length));
+}
+
+/*  **** Complexity: O(n) ****** */
+size_t SListLoopLength(const slist_node_t *head)
+{
+	size_t num_nodes = 0;
+	const slist_node_t *tail = NULL;
+
+	return (SListBrentWalk(head, &num_nodes, &tail));
 }
 
 
@@ -201,49 +302,105 @@ int SListForEach(slist_node_t *head, int (*func)(void *node_data, void *param),
 	return (0);
 }
 
+/* Number of nodes from head up to and including 'last' */
+static size_t SListCountTo(const slist_node_t *head, const slist_node_t *last)
+{
+	size_t count = 1;
+
+	for (; head != last; head = head->next)
+	{
+		++count;
+	}
+
+	return (count);
+}
+
+/* Skip the extra nodes of the longer list, then walk both together to the first common node.
+	Both lists must end at the same node ('last') */
+static const slist_node_t *SListAlignedWalk(const slist_node_t *head1, size_t len1,
+											const slist_node_t *head2, size_t len2)
+{
+	for (; len1 > len2; --len1)
+	{
+		head1 = head1->next;
+	}
+
+	for (; len2 > len1; --len2)
+	{
+		head2 = head2->next;
+	}
+
+	while (head1 != head2)
+	{
+		head1 = head1->next;
+		head2 = head2->next;
+	}
+
+	return (head1);
+}
+
 /*  **** Complexity: O(n+m) ****** */
 slist_node_t *SListFindIntersection(const slist_node_t *head1, const slist_node_t *head2)
 {
 /*
-    Count nodes of the two linked list. 
-    calculate the difference between sizes and traverses 'diff' nodes on the longer list.
-    (results in placing the two lists at same distance from intersection node)
-    walk on each list compare the nodes until finding the common.
+    One Brent pass over each list gives its length and last node (or its loop).
+    Lists without loops intersect iff they share the last node: then skip the
+    extra nodes of the longer list and walk both together to the common node.
+    
+    If the lists have loops, the loop start is used as the last node:
+    lists that enter the same loop at the same node share it as their last node,
+    lists that enter the same loop at different nodes intersect at either loop start,
+    and a list with a loop cannot intersect a list without one.
 */
- 	const slist_node_t *curr_long = NULL;
-	const slist_node_t *curr_short = NULL;
-	size_t size1, size2, diff = 0;
-	
-  	size1 = SListCount(head1);
-  	size2 = SListCount(head2); 
-  	
- 	if (size1 > size2)
- 	{
- 		diff = size1 - size2;
- 		curr_long = head1;
- 		curr_short = head2;
-  	}
-  	else
-  	{
- 		diff = size2 - size1;
-  	 	curr_long = head2;
- 		curr_short = head1;
+	const slist_node_t *last1 = NULL;
+	const slist_node_t *last2 = NULL;
+	const slist_node_t *curr_loop = NULL;
+	size_t len1 = 0;
+	size_t len2 = 0;
+	size_t loop_len1 = 0;
+	size_t loop_len2 = 0;
+
+	if (NULL == head1 || NULL == head2)
+	{
+		return (NULL);
 	}
-	
-	/* traverses 'diff' nodes on the longer list, 
-	placing the two lists at same distance from intersection node */
-	for (; diff > 0; --diff)
+
+	loop_len1 = SListBrentWalk(head1, &len1, &last1);
+	loop_len2 = SListBrentWalk(head2, &len2, &last2);
+
+	if ((0 == loop_len1) != (0 == loop_len2))
 	{
-		curr_long = curr_long->next;
+		return (NULL);
 	}
 
-	 /* walk on each list compare the nodes until finding the common.*/
-	while ((curr_long != NULL) && (curr_long != curr_short))
+	if (loop_len1 != 0)
+	{
+		last1 = SListLoopStartOf(head1, loop_len1);
+		last2 = SListLoopStartOf(head2, loop_len2);
+
+		if (last1 != last2)
+		{
+			/* both lists have loops, check if last2 is part of loop1 */
+			curr_loop = last1;
+			do
+			{
+				if (curr_loop == last2)
+				{
+					return ((slist_node_t *)last1);
+				}
+				curr_loop = curr_loop->next;
+			} while (curr_loop != last1);
+
+			return (NULL);
+		}
+
+		len1 = SListCountTo(head1, last1);
+		len2 = SListCountTo(head2, last2);
+	}
+	else if (last1 != last2)
 	{
-		curr_long = curr_long->next;
-		curr_short = curr_short->next;
+		return (NULL);
 	}
-	
-	return ((slist_node_t *)curr_long);	
-} 
 
+	return ((slist_node_t *)SListAlignedWalk(head1, len1, head2, len2));
+}
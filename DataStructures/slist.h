@@ -3,6 +3,8 @@
 
 #include <stddef.h>
 
+#include "allocator.h"
+
 typedef struct slist_node_st slist_node_t;
 
 struct slist_node_st
@@ -15,6 +17,9 @@ struct slist_node_st
 /* Create and initialize a new node, return NULL upon failure. */
 slist_node_t *SListCreateAndInitNode(void *data, slist_node_t *next);
 
+/* Same as SListCreateAndInitNode, allocating through 'allocator' (NULL for the default malloc/free) */
+slist_node_t *SListCreateAndInitNodeWithAllocator(void *data, slist_node_t *next, const allocator_t *allocator);
+
 /* Preappends a node before 'where', returns the 'where' that holds the new data, Subject to invalidation  of pointers */
 slist_node_t *SListInsert(slist_node_t *where, slist_node_t *new_node);
 
@@ -30,6 +35,13 @@ slist_node_t *SListRemoveAfter(slist_node_t *node);
 /* Free memory of all nodes starting from head */
 void SListFreeAll(slist_node_t *head);
 
+/* Free all nodes starting from head through the allocator they were created with (NULL for the default) */
+void SListFreeAllWithAllocator(slist_node_t *head, const allocator_t *allocator);
+
+/* Link the list head2..tail2 after 'tail1', the last node of another list. Returns the new tail (tail2).
+	O(1): callers that keep the tail of their list concatenate without walking it */
+slist_node_t *SListConcat(slist_node_t *tail1, slist_node_t *head2, slist_node_t *tail2);
+
 /* Return the numbers of nodes starting from the head */
 size_t SListCount(const slist_node_t *head);
 
@@ -40,6 +52,12 @@ slist_node_t *SListFind(slist_node_t *head, int (*is_match)(const void *node_dat
 /* returns 1 if the linked list has loop, or 0 otherwise */
 int SListHasLoop(const slist_node_t *head);
 
+/* Returns the first node of the loop (the node two nodes point to), or NULL if the list has no loop */
+slist_node_t *SListFindLoopStart(const slist_node_t *head);
+
+/* Returns the number of nodes in the loop, or 0 if the list has no loop */
+size_t SListLoopLength(const slist_node_t *head);
+
 /* Flips the order of nodes, and returns the new head */
 slist_node_t *SListFlip(slist_node_t *head);
 
@@ -47,6 +65,7 @@ slist_node_t *SListFlip(slist_node_t *head);
 int SListForEach(slist_node_t *head, int (*func)(void *node_data, void *param), void *param);
 
 /* Find intersection of two lists, and returns a pointer to the intersection node (or NULL if no intersection weren’t found)
+	Lists that contain a loop are supported: if both lists enter the same loop at different nodes, the loop start of head1 is returned.
 */
 slist_node_t *SListFindIntersection(const slist_node_t *head1, const slist_node_t *head2);
 
@@ -54,11 +73,14 @@ slist_node_t *SListFindIntersection(const slist_node_t *head1, const slist_node_
 
 
 
-/* Fast/Slow method to find intersection */
+/* Brent's method to find a loop */
 /*
     1. Define 2 nodes that points to the header of linked list.
-    2. Node 1 traverses faster than Node 2, say twice the speed.
-    3. If the linked list contains a cycle, then Node 1 and Node 2 will meet at some time.
+    2. Node 1 (hare) moves one node at a time, Node 2 (tortoise) stays put.
+    3. Every power of 2 steps the tortoise teleports to the hare's position.
+    4. If the linked list contains a cycle, the hare will reach the tortoise,
+       and the number of steps since the last teleport is the loop length.
+       (one pointer load per step instead of three in the fast/slow method)
     
     */
 
@@ -0,0 +1,17 @@
+#include <assert.h>
+
+#include "slist_bloom.h"
+
+/*  **** Complexity: O(1) on a filtered miss, O(n) otherwise ****** */
+slist_node_t *SListFindFiltered(slist_node_t *head, const bloom_t *filter, int (*is_match)(const void *node_data, const void *data, void *param), const void *data, void *param)
+{
+	assert(filter != NULL);
+	assert(is_match != NULL);
+
+	if (!BloomMayContain(filter, data))
+	{
+		return (NULL);
+	}
+
+	return (SListFind(head, is_match, data, param));
+}
@@ -0,0 +1,15 @@
+#ifndef SLIST_BLOOM_H_
+#define SLIST_BLOOM_H_
+
+#include "slist.h"
+#include "bloom.h"
+
+/* Bloom-filtered search over a plain slist, kept apart from slist.h so that
+	slist users don't depend on bloom.c */
+
+/* Same as SListFind, but returns NULL without walking the list when 'filter' shows 'data'
+	is missing. The caller keeps 'filter' up to date with the data of the list (BloomAdd on
+	insert, BloomRemove on remove), hashing data consistently with is_match */
+slist_node_t *SListFindFiltered(slist_node_t *head, const bloom_t *filter, int (*is_match)(const void *node_data, const void *data, void *param), const void *data, void *param);
+
+#endif   /*   SLIST_BLOOM_H_    */
@@ -1,35 +1,38 @@
 #include <stdio.h>	
-#include <stdlib.h>		/* malloc */
 #include <string.h> 	/* memmove */
 #include <assert.h>
 #include "stack.h"
+#include "stack_inline.h"	/* stack layout */
 
 /* enum defintions */
 enum ret_values { success = 0, stack_full = 1 };
 
-struct stack_st
-{
-	size_t element_size;
-	char *end; 			/* Pointer to end of stack available area 	*/
-	char *top ;			/* Pointer to element on top of stack		*/
-	
-	char data[1];
-
-};
-
 
 /* Returns pointer to a new Created stack with given number of elements , and given element size .  Returns NULL pointer if malloc failed   */ 
 stack_t *StackCreate(size_t num_elements, size_t element_size)
+{
+	return (StackCreateWithAllocator(num_elements, element_size, NULL));
+}
+
+/* ************************************************************************************ */
+
+stack_t *StackCreateWithAllocator(size_t num_elements, size_t element_size, const allocator_t *allocator)
 {
 	stack_t *stack = NULL;
 	
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+	
 	/* Alloacate memory for stack, with size for the struct and the elements  */
-	stack = (stack_t *)malloc(sizeof(stack_t) + (num_elements * element_size));	
+	stack = (stack_t *)AllocatorAlloc(allocator, sizeof(stack_t) + (num_elements * element_size));	
 	if (NULL == stack)
 	{
 		return NULL;
 	}
 				
+	stack->allocator = *allocator;
 	/* Set element_size field ,and pointer to end of available stack   */
 	stack->element_size = element_size ;
 	stack->end = stack->data + num_elements * element_size ;
@@ -46,7 +49,7 @@ void StackDestroy(stack_t *stack)
 {
 	assert(stack != NULL);
 	/* free stack */
-	free(stack);
+	AllocatorFree(&stack->allocator, stack);
 	stack =  NULL ; 
 }
 
@@ -2,11 +2,15 @@
 #define STACK_
 #include <stddef.h>
 
+#include "allocator.h"
+
 typedef struct stack_st stack_t;
 
 /* Returns pointer to a new Created stack with given number of elements , and given element size  ,  Returns NULL pointer if malloc failed   */ 
  /* StackDestroy must be used before programs ends */ 
 stack_t *StackCreate(size_t num_elements, size_t element_size);
+/* Same as StackCreate, allocating through 'allocator' (NULL for the default malloc/free) */
+stack_t *StackCreateWithAllocator(size_t num_elements, size_t element_size, const allocator_t *allocator);
 /* Destroy stack and all it's elements */
 void StackDestroy(stack_t *stack);
 /* Removes last element from stack */
@@ -0,0 +1,40 @@
+#ifndef STACK_INLINE_H_
+#define STACK_INLINE_H_
+
+#include <assert.h>
+
+#include "stack.h"
+
+/* Opt-in inline version of StackPeek, for hot loops.
+	Including this header exposes the stack layout: code that uses it must be
+	rebuilt whenever this header changes. Before C99, StackPeekInline is
+	StackPeek. */
+
+struct stack_st
+{
+	size_t element_size;
+	allocator_t allocator;	/* used to free the stack */
+	char *end; 			/* Pointer to end of stack available area 	*/
+	char *top ;			/* Pointer to element on top of stack		*/
+	
+	char data[1];
+
+};
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+
+/* returns the last element in the stack */
+static inline void *StackPeekInline(const stack_t *stack)
+{
+	assert(stack != NULL);
+	
+	return (stack->top);
+}
+
+#else /* C89 */
+
+#define StackPeekInline StackPeek
+
+#endif /* C99 */
+
+#endif /*   STACK_INLINE_H_    */
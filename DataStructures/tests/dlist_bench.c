@@ -0,0 +1,110 @@
+/* Dlist traversal benchmark: the out-of-line accessors of dlist.h against the
+	inline ones of dlist_inline.h, on the same list.
+
+	Build (from DataStructures, without -flto so dlist.c calls stay calls):
+	gcc -std=gnu99 -O2 -DNDEBUG -I. tests/dlist_bench.c dlist.c bloom.c allocator.c -o dlist_bench
+
+	Prints the time per node of each loop, best of NUM_ROUNDS. */
+
+#include <stdio.h>
+#include <time.h>		/* clock_gettime */
+
+#include "dlist.h"
+#include "dlist_inline.h"
+
+#define NUM_ELEMENTS (1000000)
+#define NUM_ROUNDS (20)
+
+static double Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static long SumOutOfLine(const dlist_t *dlist)
+{
+	dlist_iter_t iter = NULL;
+	long sum = 0;
+
+	for (iter = DlistBegin(dlist); !DlistIsSameIter(iter, DlistEnd(dlist)); iter = DlistNext(iter))
+	{
+		sum += (long)DlistGetData(iter);
+	}
+
+	return (sum);
+}
+
+static long SumInline(const dlist_t *dlist)
+{
+	dlist_iter_t iter = NULL;
+	long sum = 0;
+
+	for (iter = DlistBeginInline(dlist); !DlistIsSameIterInline(iter, DlistEndInline(dlist)); iter = DlistNextInline(iter))
+	{
+		sum += (long)DlistGetDataInline(iter);
+	}
+
+	return (sum);
+}
+
+/* Best time per node of 'sum' over NUM_ROUNDS, in ns. Sets *result to the sum */
+static double Measure(long (*sum)(const dlist_t *dlist), const dlist_t *dlist, long *result)
+{
+	double best = 0;
+	double start = 0;
+	double elapsed = 0;
+	int i = 0;
+
+	for (i = 0; i < NUM_ROUNDS; ++i)
+	{
+		start = Now();
+		*result = sum(dlist);
+		elapsed = Now() - start;
+
+		if (0 == i || elapsed < best)
+		{
+			best = elapsed;
+		}
+	}
+
+	return (best * 1e9 / NUM_ELEMENTS);
+}
+
+int main(void)
+{
+	dlist_t *dlist = NULL;
+	double out_of_line = 0;
+	double in_line = 0;
+	long sum1 = 0;
+	long sum2 = 0;
+	long i = 0;
+
+	dlist = DlistCreate();
+	if (NULL == dlist)
+	{
+		return (1);
+	}
+
+	for (i = 0; i < NUM_ELEMENTS; ++i)
+	{
+		if (DlistIsSameIter(DlistPushBack(dlist, (void *)i), DlistEnd(dlist)))
+		{
+			DlistDestroy(dlist);
+			return (1);
+		}
+	}
+
+	out_of_line = Measure(SumOutOfLine, dlist, &sum1);
+	in_line = Measure(SumInline, dlist, &sum2);
+
+	printf("%d nodes\n", NUM_ELEMENTS);
+	printf("out of line: %.2f ns/node\n", out_of_line);
+	printf("inline:      %.2f ns/node (%.2fx)\n", in_line, out_of_line / in_line);
+
+	DlistDestroy(dlist);
+
+	return (sum1 != sum2);
+}
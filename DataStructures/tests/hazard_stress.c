@@ -0,0 +1,168 @@
+/* Hazard pointer stress test: a lock-free Treiber stack shared by NUM_THREADS
+	threads. Every popped node is retired through HazardRetire, so a missing
+	hazard check shows up as a use after free (ASan) or a data race (TSan).
+
+	Build (from DataStructures):
+	gcc -std=gnu99 -g -O1 -fsanitize=address,undefined -I. tests/hazard_stress.c hazard.c -o hazard_stress -lpthread
+	gcc -std=gnu99 -g -O1 -fsanitize=thread -I. tests/hazard_stress.c hazard.c -o hazard_stress -lpthread
+
+	Exits with 0 if every pushed value was popped exactly once and every node
+	was reclaimed exactly once. */
+
+#include <stdio.h>
+#include <stdlib.h>		/* malloc, free */
+#include <pthread.h>
+
+#include "hazard.h"
+
+#define NUM_THREADS (4)
+#define OPS_PER_THREAD (200000)
+
+typedef struct stack_node_st stack_node_t;
+
+struct stack_node_st
+{
+	stack_node_t *next;
+	long value;
+};
+
+static stack_node_t *g_top = NULL;
+static hazard_domain_t *g_domain = NULL;
+static long g_num_reclaimed = 0;
+
+/* ************************************************************************************ */
+
+static void Reclaim(void *ptr, void *param)
+{
+	(void)param;
+
+	__atomic_add_fetch(&g_num_reclaimed, 1, __ATOMIC_RELAXED);
+	free(ptr);
+}
+
+static int Push(long value)
+{
+	stack_node_t *node = (stack_node_t *)malloc(sizeof(stack_node_t));
+
+	if (NULL == node)
+	{
+		return (1);
+	}
+
+	node->value = value;
+	node->next = __atomic_load_n(&g_top, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&g_top, &node->next, node, 1,
+										__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	{
+	}
+
+	return (0);
+}
+
+/* Pop a node into *value. Returns 1 if the stack was empty */
+static int Pop(hazard_record_t *record, long *value)
+{
+	stack_node_t *top = NULL;
+	stack_node_t *next = NULL;
+
+	for (;;)
+	{
+		top = (stack_node_t *)HazardProtect(record, 0, (void *const *)&g_top);
+		if (NULL == top)
+		{
+			return (1);
+		}
+
+		/* safe: 'top' can't be reclaimed while it is protected */
+		next = __atomic_load_n(&top->next, __ATOMIC_RELAXED);
+		if (__atomic_compare_exchange_n(&g_top, &top, next, 0,
+										__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			break;
+		}
+	}
+
+	HazardClear(record, 0);
+
+	*value = top->value;
+	while (0 != HazardRetire(record, top))
+	{
+	}
+
+	return (0);
+}
+
+static void *Worker(void *param)
+{
+	hazard_record_t *record = NULL;
+	long *sum = (long *)param;
+	long value = 0;
+	long i = 0;
+
+	record = HazardAcquire(g_domain);
+	if (NULL == record)
+	{
+		return (NULL);
+	}
+
+	for (i = 1; i <= OPS_PER_THREAD; ++i)
+	{
+		while (0 != Push(i))
+		{
+		}
+
+		if (0 == Pop(record, &value))
+		{
+			*sum += value;
+		}
+	}
+
+	HazardRelease(record);
+
+	return (NULL);
+}
+
+/* ************************************************************************************ */
+
+int main(void)
+{
+	pthread_t threads[NUM_THREADS];
+	long sums[NUM_THREADS] = {0};
+	hazard_record_t *record = NULL;
+	long expected = (long)NUM_THREADS * OPS_PER_THREAD * (OPS_PER_THREAD + 1) / 2;
+	long total = 0;
+	long value = 0;
+	int i = 0;
+
+	g_domain = HazardDomainCreate(1, Reclaim, NULL);
+	if (NULL == g_domain)
+	{
+		return (1);
+	}
+
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		pthread_create(&threads[i], NULL, Worker, &sums[i]);
+	}
+
+	for (i = 0; i < NUM_THREADS; ++i)
+	{
+		pthread_join(threads[i], NULL);
+		total += sums[i];
+	}
+
+	/* drain what the workers left */
+	record = HazardAcquire(g_domain);
+	while (0 == Pop(record, &value))
+	{
+		total += value;
+	}
+	HazardRelease(record);
+
+	HazardDomainDestroy(g_domain);
+
+	printf("sum %ld (expected %ld), reclaimed %ld (expected %ld)\n",
+		   total, expected, g_num_reclaimed, (long)NUM_THREADS * OPS_PER_THREAD);
+
+	return (total != expected || g_num_reclaimed != (long)NUM_THREADS * OPS_PER_THREAD);
+}
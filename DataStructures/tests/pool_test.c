@@ -0,0 +1,118 @@
+/* Containers on a pool: a dlist and a queue whose nodes come from a pool_t
+	through PoolAllocatorInit, while the container structs themselves (larger
+	than a pool object) fall back to malloc.
+
+	Build (from DataStructures):
+	gcc -std=gnu99 -g -fsanitize=address,undefined -I. tests/pool_test.c pool.c stack.c dlist.c queue.c slist.c bloom.c allocator.c -o pool_test -lpthread
+
+	Exits with 0 if every check passed. */
+
+#include <stdio.h>
+
+#include "pool.h"
+#include "dlist.h"
+#include "queue.h"
+
+#define POOL_COUNT (64)
+#define NODE_SIZE (3 * sizeof(void *))	/* the largest node: data, next, prev */
+#define NUM_ELEMENTS (40)
+
+static int g_failures = 0;
+
+static void Check(int condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAIL: %s\n", what);
+		++g_failures;
+	}
+}
+
+/* ************************************************************************************ */
+
+static void TestDlist(pool_t *pool, const allocator_t *allocator)
+{
+	dlist_t *dlist = NULL;
+	dlist_iter_t iter = NULL;
+	long i = 0;
+
+	dlist = DlistCreateWithAllocator(allocator);
+	Check(NULL != dlist, "dlist created on a pool");
+	if (NULL == dlist)
+	{
+		return;
+	}
+
+	for (i = 0; i < NUM_ELEMENTS; ++i)
+	{
+		Check(!DlistIsSameIter(DlistPushBack(dlist, (void *)i), DlistEnd(dlist)), "dlist push");
+	}
+
+	Check(NUM_ELEMENTS == DlistSize(dlist), "dlist size");
+	Check(PoolAvailable(pool) < POOL_COUNT, "dlist nodes come from the pool");
+
+	for (i = 0, iter = DlistBegin(dlist); !DlistIsSameIter(iter, DlistEnd(dlist)); iter = DlistNext(iter), ++i)
+	{
+		Check((void *)i == DlistGetData(iter), "dlist order");
+	}
+
+	Check((void *)0 == DlistPopFront(dlist), "dlist pop");
+
+	DlistDestroy(dlist);
+	Check(POOL_COUNT == PoolAvailable(pool), "dlist returned every node");
+}
+
+static void TestQueue(pool_t *pool, const allocator_t *allocator)
+{
+	queue_t *queue = NULL;
+	long i = 0;
+
+	queue = QueueCreateWithAllocator(allocator);
+	Check(NULL != queue, "queue created on a pool");
+	if (NULL == queue)
+	{
+		return;
+	}
+
+	/* more than the inline slots, so the queue spills into pool nodes */
+	for (i = 0; i < NUM_ELEMENTS; ++i)
+	{
+		Check(0 == QueueEnqueue(queue, (void *)i), "queue enqueue");
+	}
+
+	Check(NUM_ELEMENTS == QueueSize(queue), "queue size");
+	Check(PoolAvailable(pool) < POOL_COUNT, "queue nodes come from the pool");
+
+	for (i = 0; i < NUM_ELEMENTS / 2; ++i)
+	{
+		Check((void *)i == QueueDequeue(queue), "queue order");
+	}
+
+	QueueDestroy(queue);
+	Check(POOL_COUNT == PoolAvailable(pool), "queue returned every node");
+}
+
+/* ************************************************************************************ */
+
+int main(void)
+{
+	pool_t *pool = NULL;
+	allocator_t allocator;
+
+	pool = PoolCreate(POOL_COUNT, NODE_SIZE);
+	if (NULL == pool)
+	{
+		return (1);
+	}
+
+	PoolAllocatorInit(pool, &allocator);
+
+	TestDlist(pool, &allocator);
+	TestQueue(pool, &allocator);
+
+	PoolDestroy(pool);
+
+	printf("%s\n", (0 == g_failures) ? "OK" : "FAILED");
+
+	return (0 != g_failures);
+}
@@ -0,0 +1,145 @@
+/* Scheduler scaling benchmark and idle-CPU check.
+
+	Build (from DataStructures):
+	gcc -std=gnu99 -O2 -I. tests/scheduler_bench.c scheduler.c wsdeque.c queue.c slist.c allocator.c -o scheduler_bench -lpthread
+
+	1. fork/join fib(FIB_N) with 1, 2, 4, ... workers: wall time and speedup.
+	2. one task sleeping IDLE_TASK_MS with 4 workers: the CPU time used by the
+	   process should stay far below the wall time (idle workers must block). */
+
+#include <stdio.h>
+#include <time.h>			/* clock_gettime, nanosleep */
+#include <sys/resource.h>	/* getrusage */
+#include <unistd.h>			/* sysconf */
+
+#include "scheduler.h"
+
+#define FIB_N (38)
+#define SEQUENTIAL_CUTOFF (18)
+#define IDLE_TASK_MS (1000)
+
+typedef struct fib_st fib_t;
+
+struct fib_st
+{
+	scheduler_t *sched;
+	long n;
+	long result;
+};
+
+static double Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static double CpuTime(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	return (usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+			usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+}
+
+static long FibSequential(long n)
+{
+	return ((n < 2) ? n : FibSequential(n - 1) + FibSequential(n - 2));
+}
+
+static void Fib(void *param)
+{
+	fib_t *fib = (fib_t *)param;
+	fib_t sub1 = {NULL, 0, 0};
+	fib_t sub2 = {NULL, 0, 0};
+	size_t join = 0;
+
+	if (fib->n < SEQUENTIAL_CUTOFF)
+	{
+		fib->result = FibSequential(fib->n);
+		return;
+	}
+
+	sub1.sched = sub2.sched = fib->sched;
+	sub1.n = fib->n - 1;
+	sub2.n = fib->n - 2;
+
+	SchedulerSpawn(fib->sched, Fib, &sub1, &join);
+	SchedulerSpawn(fib->sched, Fib, &sub2, &join);
+	SchedulerJoin(fib->sched, &join);
+
+	fib->result = sub1.result + sub2.result;
+}
+
+static void Sleep(void *param)
+{
+	struct timespec ts = {IDLE_TASK_MS / 1000, (IDLE_TASK_MS % 1000) * 1000000L};
+
+	(void)param;
+	nanosleep(&ts, NULL);
+}
+
+int main(void)
+{
+	scheduler_t *sched = NULL;
+	fib_t fib = {NULL, FIB_N, 0};
+	size_t join = 0;
+	size_t num_workers = 0;
+	size_t max_workers = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+	double start = 0;
+	double base = 0;
+	double elapsed = 0;
+	double cpu = 0;
+
+	printf("fib(%d), cutoff %d\n", FIB_N, SEQUENTIAL_CUTOFF);
+	printf("%8s %10s %8s\n", "workers", "seconds", "speedup");
+
+	for (num_workers = 1; num_workers <= max_workers; num_workers *= 2)
+	{
+		sched = SchedulerCreate(num_workers);
+		if (NULL == sched)
+		{
+			return (1);
+		}
+
+		fib.sched = sched;
+		fib.result = 0;
+		join = 0;
+
+		start = Now();
+		SchedulerSpawn(sched, Fib, &fib, &join);
+		SchedulerJoin(sched, &join);
+		elapsed = Now() - start;
+
+		if (1 == num_workers)
+		{
+			base = elapsed;
+		}
+		printf("%8lu %10.3f %8.2f   (result %ld)\n",
+			   (unsigned long)num_workers, elapsed, base / elapsed, fib.result);
+
+		SchedulerDestroy(sched);
+	}
+
+	sched = SchedulerCreate(4);
+	if (NULL == sched)
+	{
+		return (1);
+	}
+
+	join = 0;
+	cpu = CpuTime();
+	start = Now();
+	SchedulerSpawn(sched, Sleep, NULL, &join);
+	SchedulerJoin(sched, &join);
+	printf("one %d ms task on 4 workers: %.3f s wall, %.3f s cpu\n",
+		   IDLE_TASK_MS, Now() - start, CpuTime() - cpu);
+
+	SchedulerDestroy(sched);
+
+	return (0);
+}
@@ -0,0 +1,299 @@
+/* 'current' is the next tick to be processed.
+	A timer due in 'delta' ticks goes to the first level whose range covers delta,
+	in slot (expires >> (LEVEL_BITS * level)) & SLOT_MASK.
+	Processing tick t:
+	1. if t is a multiple of 64, cascade level 1 slot of t (and level 2 if t is a
+	   multiple of 64^2, ...): every timer there is re-placed relative to t.
+	2. splice level 0 slot of t to the 'expired' list.
+	Callbacks are called from 'expired' once all ticks up to 'now' are processed. */
+
+#include <assert.h>
+
+#include "timerwheel.h"
+
+#define NUM_LEVELS (4)
+#define LEVEL_BITS (6)
+#define SLOTS_PER_LEVEL (1UL << LEVEL_BITS)
+#define SLOT_MASK (SLOTS_PER_LEVEL - 1)
+#define MAX_DELTA ((1UL << (LEVEL_BITS * NUM_LEVELS)) - 1)
+
+typedef struct wheel_timer_st wheel_timer_t;
+
+struct wheel_timer_st
+{
+	unsigned long expires;
+	void (*callback)(void *param);
+	void *param;
+	dlist_t *slot;			/* the list holding the timer, needed to erase it */
+};
+
+struct timer_wheel_st
+{
+	unsigned long current;
+	size_t num_pending;
+	dlist_t *expired;
+	dlist_t *slots[NUM_LEVELS][SLOTS_PER_LEVEL];
+	allocator_t allocator;	/* used for the wheel, its lists and timers */
+};
+
+/* ************************************************************************************ */
+
+/* Returns the slot a timer belongs to, relative to the wheel's current tick */
+static dlist_t *SlotOf(const timer_wheel_t *wheel, unsigned long expires)
+{
+	unsigned long delta = 0;
+	size_t level = 0;
+
+	if (expires < wheel->current)
+	{
+		expires = wheel->current;
+	}
+
+	delta = expires - wheel->current;
+	if (delta > MAX_DELTA)
+	{
+		/* parked in the farthest slot, re-placed when it is cascaded */
+		expires = wheel->current + MAX_DELTA;
+		delta = MAX_DELTA;
+	}
+
+	while (delta >> (LEVEL_BITS * (level + 1)) != 0)
+	{
+		++level;
+	}
+
+	return (wheel->slots[level][(expires >> (LEVEL_BITS * level)) & SLOT_MASK]);
+}
+
+/* Move the single node 'iter' to the end of 'slot' */
+static void MoveTimer(dlist_iter_t iter, dlist_t *slot)
+{
+	wheel_timer_t *timer = (wheel_timer_t *)DlistGetData(iter);
+
+	DlistSpliceFrom(slot, DlistEnd(slot), timer->slot, iter, DlistNext(iter));
+	timer->slot = slot;
+}
+
+/* Re-place every timer of 'slot' relative to the current tick */
+static void Cascade(timer_wheel_t *wheel, dlist_t *slot)
+{
+	dlist_iter_t iter = NULL;
+	wheel_timer_t *timer = NULL;
+
+	while (!DlistIsEmpty(slot))
+	{
+		iter = DlistBegin(slot);
+		timer = (wheel_timer_t *)DlistGetData(iter);
+
+		MoveTimer(iter, SlotOf(wheel, timer->expires));
+	}
+}
+
+/* Process one tick: cascade, then collect level 0 into 'expired' */
+static void Tick(timer_wheel_t *wheel)
+{
+	unsigned long tick = wheel->current;
+	size_t level = 1;
+	dlist_t *due = wheel->slots[0][tick & SLOT_MASK];
+
+	/* cascade level 'level' while all finer levels wrapped around */
+	while (level < NUM_LEVELS &&
+		   0 == ((tick >> (LEVEL_BITS * (level - 1))) & SLOT_MASK))
+	{
+		Cascade(wheel, wheel->slots[level][(tick >> (LEVEL_BITS * level)) & SLOT_MASK]);
+		++level;
+	}
+
+	while (!DlistIsEmpty(due))
+	{
+		MoveTimer(DlistBegin(due), wheel->expired);
+	}
+
+	++wheel->current;
+}
+
+/* Destroy the first 'num_slots' slot lists (level by level) and the wheel, freeing their timers */
+static void DestroySlots(timer_wheel_t *wheel, size_t num_slots)
+{
+	dlist_t *slot = NULL;
+	size_t i = 0;
+
+	for (i = 0; i < num_slots; ++i)
+	{
+		slot = wheel->slots[i / SLOTS_PER_LEVEL][i % SLOTS_PER_LEVEL];
+
+		while (!DlistIsEmpty(slot))
+		{
+			AllocatorFree(&wheel->allocator, DlistPopFront(slot));
+		}
+		DlistDestroy(slot);
+	}
+}
+
+/* ************************************************************************************ */
+
+timer_wheel_t *TimerWheelCreate(unsigned long now)
+{
+	return (TimerWheelCreateWithAllocator(now, NULL));
+}
+
+/* ************************************************************************************ */
+
+timer_wheel_t *TimerWheelCreateWithAllocator(unsigned long now, const allocator_t *allocator)
+{
+	timer_wheel_t *wheel = NULL;
+	size_t i = 0;
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	wheel = (timer_wheel_t *)AllocatorAlloc(allocator, sizeof(timer_wheel_t));
+	if (NULL == wheel)
+	{
+		return (NULL);
+	}
+
+	wheel->allocator = *allocator;
+
+	wheel->expired = DlistCreateWithAllocator(allocator);
+	if (NULL == wheel->expired)
+	{
+		AllocatorFree(allocator, wheel);
+		return (NULL);
+	}
+
+	for (i = 0; i < NUM_LEVELS * SLOTS_PER_LEVEL; ++i)
+	{
+		wheel->slots[i / SLOTS_PER_LEVEL][i % SLOTS_PER_LEVEL] = DlistCreateWithAllocator(allocator);
+		if (NULL == wheel->slots[i / SLOTS_PER_LEVEL][i % SLOTS_PER_LEVEL])
+		{
+			DestroySlots(wheel, i);
+			DlistDestroy(wheel->expired);
+			AllocatorFree(allocator, wheel);
+			return (NULL);
+		}
+	}
+
+	wheel->current = now;
+	wheel->num_pending = 0;
+
+	return (wheel);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(n) ****** */
+void TimerWheelDestroy(timer_wheel_t *wheel)
+{
+	assert(wheel != NULL);
+
+	DestroySlots(wheel, NUM_LEVELS * SLOTS_PER_LEVEL);
+
+	while (!DlistIsEmpty(wheel->expired))
+	{
+		AllocatorFree(&wheel->allocator, DlistPopFront(wheel->expired));
+	}
+	DlistDestroy(wheel->expired);
+
+	AllocatorFree(&wheel->allocator, wheel);
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+dlist_iter_t TimerWheelAdd(timer_wheel_t *wheel, unsigned long expires,
+							void (*callback)(void *param), void *param)
+{
+	wheel_timer_t *timer = NULL;
+	dlist_iter_t iter = NULL;
+
+	assert(wheel != NULL);
+	assert(callback != NULL);
+
+	timer = (wheel_timer_t *)AllocatorAlloc(&wheel->allocator, sizeof(wheel_timer_t));
+	if (NULL == timer)
+	{
+		return (NULL);
+	}
+
+	timer->expires = expires;
+	timer->callback = callback;
+	timer->param = param;
+	timer->slot = SlotOf(wheel, expires);
+
+	iter = DlistPushBack(timer->slot, timer);
+	if (DlistIsSameIter(iter, DlistEnd(timer->slot)))
+	{
+		AllocatorFree(&wheel->allocator, timer);
+		return (NULL);
+	}
+
+	++wheel->num_pending;
+
+	return (iter);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+void TimerWheelCancel(timer_wheel_t *wheel, dlist_iter_t timer)
+{
+	wheel_timer_t *wheel_timer = NULL;
+
+	assert(wheel != NULL);
+	assert(timer != NULL);
+
+	wheel_timer = (wheel_timer_t *)DlistGetData(timer);
+
+	DlistEraseFrom(wheel_timer->slot, timer);
+	AllocatorFree(&wheel->allocator, wheel_timer);
+
+	--wheel->num_pending;
+
+	return;
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(ticks + expired timers) ****** */
+size_t TimerWheelAdvance(timer_wheel_t *wheel, unsigned long now)
+{
+	wheel_timer_t *timer = NULL;
+	size_t num_fired = 0;
+
+	assert(wheel != NULL);
+
+	while (wheel->current <= now)
+	{
+		if (0 == wheel->num_pending)
+		{
+			/* nothing to cascade or fire, jump */
+			wheel->current = now + 1;
+			break;
+		}
+
+		Tick(wheel);
+	}
+
+	while (!DlistIsEmpty(wheel->expired))
+	{
+		timer = (wheel_timer_t *)DlistPopFront(wheel->expired);
+		--wheel->num_pending;
+
+		timer->callback(timer->param);
+		AllocatorFree(&wheel->allocator, timer);
+
+		++num_fired;
+	}
+
+	return (num_fired);
+}
+
+/* ************************************************************************************ */
+/*  **** Complexity: O(1) ****** */
+size_t TimerWheelPending(const timer_wheel_t *wheel)
+{
+	assert(wheel != NULL);
+
+	return (wheel->num_pending);
+}
@@ -0,0 +1,44 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <stddef.h> /* size_t */
+
+#include "dlist.h"
+
+/* Hierarchical timing wheel.
+	4 levels of 64 slots, each slot is a dlist_t of timers. Level 0 slots are
+	one tick wide, each higher level is 64 times coarser. When the wheel turns
+	past a full level it cascades the next coarser slot into the finer levels.
+	Timers further away than 64^4 ticks wait in the last level until they fit. */
+
+typedef struct timer_wheel_st timer_wheel_t;
+
+/* Returns pointer to a new wheel whose time starts at tick 'now', NULL on failure.
+	Note: must be released by using TimerWheelDestroy. */
+timer_wheel_t *TimerWheelCreate(unsigned long now);
+
+/* Same as TimerWheelCreate, the wheel, its slot lists and its timers are allocated
+	through 'allocator' (NULL for the default malloc/free) */
+timer_wheel_t *TimerWheelCreateWithAllocator(unsigned long now, const allocator_t *allocator);
+
+/* Destroy the wheel, pending timers are dropped without being called */
+void TimerWheelDestroy(timer_wheel_t *wheel);
+
+/* Schedule callback(param) for tick 'expires' (a tick already passed fires on the next advance).
+	Returns the timer handle, NULL on failure.
+	The handle is valid until the timer fires or is cancelled. */
+dlist_iter_t TimerWheelAdd(timer_wheel_t *wheel, unsigned long expires,
+							void (*callback)(void *param), void *param);
+
+/* Cancel a pending timer. May be called from a callback for any other pending timer */
+void TimerWheelCancel(timer_wheel_t *wheel, dlist_iter_t timer);
+
+/* Move time forward to tick 'now' and call every expired callback, in expiry order.
+	Callbacks may add and cancel timers, but must not call TimerWheelAdvance.
+	Returns the number of callbacks called. */
+size_t TimerWheelAdvance(timer_wheel_t *wheel, unsigned long now);
+
+/* returns number of pending timers */
+size_t TimerWheelPending(const timer_wheel_t *wheel);
+
+#endif   /*   TIMERWHEEL_H_    */
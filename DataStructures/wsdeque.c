@@ -0,0 +1,256 @@
+/* Chase-Lev work-stealing deque (with the C11 memory model mapping of Le et al.)
+
+	'bottom' is written only by the owner, 'top' is advanced by CAS by whoever
+	takes the top element (thief, or the owner when one element is left).
+	The buffer is circular; when it is full the owner copies it into a buffer
+	twice the size. Thieves may still read the old buffer, so old buffers are
+	kept in a chain and released only in WsDequeDestroy. */
+
+#include <assert.h>
+
+#include "wsdeque.h"
+
+typedef struct ws_array_st ws_array_t;
+
+struct ws_array_st
+{
+	size_t size;			/* number of slots, power of 2 */
+	ws_array_t *retired;	/* previous (smaller) buffer, still readable by thieves */
+	void *slots[1];
+};
+
+struct ws_deque_st
+{
+	long top;				/* next element to steal */
+	char pad1[64 - sizeof(long)];	/* keep thieves and owner on separate cache lines */
+	long bottom;			/* next free slot for the owner */
+	char pad2[64 - sizeof(long)];
+	ws_array_t *array;
+	allocator_t allocator;	/* used for the deque and its buffers */
+};
+
+static ws_array_t *WsArrayCreate(const allocator_t *allocator, size_t size, ws_array_t *retired)
+{
+	ws_array_t *array = NULL;
+
+	array = (ws_array_t *)AllocatorAlloc(allocator, sizeof(ws_array_t) + (size - 1) * sizeof(void *));
+	if (NULL == array)
+	{
+		return (NULL);
+	}
+
+	array->size = size;
+	array->retired = retired;
+
+	return (array);
+}
+
+static void *WsArrayGet(const ws_array_t *array, long index)
+{
+	return (__atomic_load_n(&array->slots[(size_t)index & (array->size - 1)], __ATOMIC_RELAXED));
+}
+
+static void WsArrayPut(ws_array_t *array, long index, void *data)
+{
+	__atomic_store_n(&array->slots[(size_t)index & (array->size - 1)], data, __ATOMIC_RELAXED);
+}
+
+/* Copy elements [top, bottom) to a buffer twice the size. Returns NULL on failure */
+static ws_array_t *WsDequeGrow(ws_deque_t *deque, ws_array_t *array, long top, long bottom)
+{
+	ws_array_t *new_array = NULL;
+	long i = 0;
+
+	new_array = WsArrayCreate(&deque->allocator, array->size * 2, array);
+	if (NULL == new_array)
+	{
+		return (NULL);
+	}
+
+	for (i = top; i < bottom; ++i)
+	{
+		WsArrayPut(new_array, i, WsArrayGet(array, i));
+	}
+
+	__atomic_store_n(&deque->array, new_array, __ATOMIC_RELEASE);
+
+	return (new_array);
+}
+
+/*  **** Complexity: O(1) ****** */
+ws_deque_t *WsDequeCreate(size_t capacity)
+{
+	return (WsDequeCreateWithAllocator(capacity, NULL));
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
+ws_deque_t *WsDequeCreateWithAllocator(size_t capacity, const allocator_t *allocator)
+{
+	ws_deque_t *deque = NULL;
+	size_t size = 2;
+
+	if (NULL == allocator)
+	{
+		allocator = AllocatorDefault();
+	}
+
+	/* round capacity up to a power of 2 */
+	while (size < capacity)
+	{
+		size *= 2;
+	}
+
+	deque = (ws_deque_t *)AllocatorAlloc(allocator, sizeof(ws_deque_t));
+	if (NULL == deque)
+	{
+		return (NULL);
+	}
+
+	deque->array = WsArrayCreate(allocator, size, NULL);
+	if (NULL == deque->array)
+	{
+		AllocatorFree(allocator, deque);
+		return (NULL);
+	}
+
+	deque->allocator = *allocator;
+
+	deque->top = 0;
+	deque->bottom = 0;
+
+	return (deque);
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
+void WsDequeDestroy(ws_deque_t *deque)
+{
+	ws_array_t *array = NULL;
+	ws_array_t *retired = NULL;
+
+	assert(deque != NULL);
+
+	for (array = deque->array; array != NULL; array = retired)
+	{
+		retired = array->retired;
+		AllocatorFree(&deque->allocator, array);
+	}
+
+	AllocatorFree(&deque->allocator, deque);
+
+	return;
+}
+/*********************************/
+/*  **** Complexity: O(1) amortized ****** */
+int WsDequePush(ws_deque_t *deque, void *data)
+{
+	long bottom = 0;
+	long top = 0;
+	ws_array_t *array = NULL;
+
+	assert(deque != NULL);
+
+	bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+	top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	array = __atomic_load_n(&deque->array, __ATOMIC_RELAXED);
+
+	if ((size_t)(bottom - top) > array->size - 1)
+	{
+		array = WsDequeGrow(deque, array, top, bottom);
+		if (NULL == array)
+		{
+			return (1);
+		}
+	}
+
+	WsArrayPut(array, bottom, data);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+	return (0);
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
+void *WsDequePop(ws_deque_t *deque)
+{
+	long bottom = 0;
+	long top = 0;
+	ws_array_t *array = NULL;
+	void *ret_data = NULL;
+
+	assert(deque != NULL);
+
+	/* reserve the bottom element before looking at 'top' */
+	bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+	array = __atomic_load_n(&deque->array, __ATOMIC_RELAXED);
+	__atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+	if (top > bottom)
+	{
+		/* deque was empty, restore bottom */
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return (NULL);
+	}
+
+	ret_data = WsArrayGet(array, bottom);
+
+	if (top == bottom)
+	{
+		/* last element - race against thieves on 'top' */
+		if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+										__ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+		{
+			ret_data = NULL;
+		}
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+	}
+
+	return (ret_data);
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
+void *WsDequeSteal(ws_deque_t *deque)
+{
+	long bottom = 0;
+	long top = 0;
+	ws_array_t *array = NULL;
+	void *ret_data = NULL;
+
+	assert(deque != NULL);
+
+	top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+	if (top >= bottom)
+	{
+		return (NULL);
+	}
+
+	array = __atomic_load_n(&deque->array, __ATOMIC_ACQUIRE);
+	ret_data = WsArrayGet(array, top);
+
+	if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+									__ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+	{
+		/* lost the race to another thief or the owner */
+		return (NULL);
+	}
+
+	return (ret_data);
+}
+/*********************************/
+/*  **** Complexity: O(1) ****** */
+size_t WsDequeSize(const ws_deque_t *deque)
+{
+	long bottom = 0;
+	long top = 0;
+
+	assert(deque != NULL);
+
+	bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+	top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+	return ((bottom > top) ? (size_t)(bottom - top) : 0);
+}
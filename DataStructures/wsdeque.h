@@ -0,0 +1,39 @@
+#ifndef WSDEQUE_H_
+#define WSDEQUE_H_
+
+#include <stddef.h> /* size_t */
+
+#include "allocator.h"
+
+/* Chase-Lev work-stealing deque.
+	The owner thread pushes and pops at the bottom (LIFO, like stack_t),
+	any other thread may steal from the top (FIFO) without locks. */
+
+typedef struct ws_deque_st ws_deque_t;
+
+/* Returns pointer to a new deque with room for at least 'capacity' elements
+	(grows on demand), NULL on failure.
+	Note: must be released by using WsDequeDestroy. */
+ws_deque_t *WsDequeCreate(size_t capacity);
+
+/* Same as WsDequeCreate, the deque and its buffers are allocated through 'allocator'
+	(NULL for the default malloc/free) */
+ws_deque_t *WsDequeCreateWithAllocator(size_t capacity, const allocator_t *allocator);
+
+/* Destroy the deque. No other thread may use it anymore. */
+void WsDequeDestroy(ws_deque_t *deque);
+
+/* Owner only: push data to the bottom. Returns 0 for success and 1 for failure */
+int WsDequePush(ws_deque_t *deque, void *data);
+
+/* Owner only: pop data from the bottom. Returns NULL if deque is empty */
+void *WsDequePop(ws_deque_t *deque);
+
+/* Any thread: steal data from the top.
+	Returns NULL if deque is empty or the steal lost a race */
+void *WsDequeSteal(ws_deque_t *deque);
+
+/* Approximate number of elements (exact when called by the owner with no thieves) */
+size_t WsDequeSize(const ws_deque_t *deque);
+
+#endif   /*   WSDEQUE_H_    */